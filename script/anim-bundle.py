@@ -0,0 +1,8 @@
+#!/usr/bin/env python
+import helper
+
+script = "tool/anim-bundle/SConscript"
+is_debug = 0
+helper.exec_cmd(f'scons -j4 -Q debug={is_debug} -Q script={script}')
+helper.set_work_dir("build")
+helper.exec_cmd("./anim-bundle config/animation.yml config/animation.bin")
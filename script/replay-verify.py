@@ -0,0 +1,41 @@
+#!/usr/bin/env python
+# прогоняет все реплеи из папки через headless режим игры и сверяет хэши состояния.
+# Ожидаемый хэш лежит рядом с реплеем в файле <реплей>.hash,
+# если его нет, то он будет создан по результату прогона.
+# Использование: replay-verify.py [папка с реплеями] (по умолчанию build/replays)
+import glob
+import os
+import subprocess
+import sys
+
+game_exe = os.path.abspath("build/HPW.exe" if os.name == "nt" else "build/HPW")
+replay_dir = sys.argv[1] if len(sys.argv) > 1 else "build/replays"
+replays = sorted(glob.glob(os.path.join(replay_dir, "*.hpw_replay")))
+if not replays:
+  print(f'no replays in \"{replay_dir}\"')
+  sys.exit(1)
+
+failed = 0
+for replay in replays:
+  hash_file = replay + ".hash"
+  cmd = [game_exe, "--headless", "--frame-step", "0", "--replay", os.path.abspath(replay)]
+  if os.path.exists(hash_file):
+    cmd.extend(["--expect", open(hash_file).read().strip()])
+
+  print(f'replay \"{replay}\"')
+  result = subprocess.run(cmd, cwd=os.path.dirname(game_exe), capture_output=True, text=True)
+  print(result.stdout)
+  if result.returncode != 0:
+    print(result.stderr)
+    failed += 1
+    continue
+
+  # сохранить хэш первого прогона как эталон
+  if not os.path.exists(hash_file):
+    for line in result.stdout.splitlines():
+      if line.startswith("state hash: "):
+        open(hash_file, "w").write(line.split(": ")[1] + "\n")
+        print(f'saved \"{hash_file}\"')
+
+print(f'checked: {len(replays)}, failed: {failed}')
+sys.exit(1 if failed else 0)
@@ -1,4 +1,6 @@
 #pragma once
+#include <chrono>
+#include "util/macro.hpp"
 #include "util/mem-types.hpp"
 #ifdef CLD_DEBUG
 #include <atomic>
@@ -21,6 +23,30 @@ inline bool show_entity_mem_map {false};
 @details нужен чтобы выявить места, где нельзя вызывать такие рандомы */
 inline bool allow_random_stable {false};
 inline bool allow_random_stable_bak {false};
+
+/// сколько секунд заняли апдейты подсистем в сцене игры
+struct Update_profile {
+  double level {};
+  double entities {}; /// вместе с коллизиями
+  double collisions {};
+  double hud {};
+  double camera {};
+  double post_effects {};
+};
+inline Update_profile update_profile {};
+inline bool enable_update_profile {false}; /// замерять update_profile
+
+/// вызывает func и прибавляет время её работы к dst, если включён замер
+template <class Func>
+void profiled_call(double& dst, Func&& func) {
+  if ( !enable_update_profile) {
+    func();
+    return;
+  }
+  cauto st = std::chrono::steady_clock::now();
+  func();
+  dst += std::chrono::duration<double>(std::chrono::steady_clock::now() - st).count();
+}
 } // hpw ns
 
 namespace graphic {
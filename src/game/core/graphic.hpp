@@ -21,6 +21,7 @@ inline bool blink_motion_blur   {true}; /// включает мигание пр
 inline bool motion_blur_quality_reduct {true}; /// уменьшить качество размытия при render_lag
 inline bool enable_motion_blur  {true};
 inline bool cpu_safe            {false}; /// при VSync снижает нагрузку на CPU, но -кадры
+inline bool render_thread       {false}; /// выводить кадры на экран в отдельном потоке (применяется при запуске)
 inline bool fullscreen          {false};
 inline bool double_buffering    {true};
 inline bool draw_border         {true}; /// показывать рамку на весь экране
@@ -29,6 +30,7 @@ inline bool start_focused       {false}; /// запускает окно сра
 inline bool enable_light        {true}; /// отображает вспышки
 inline bool enable_heat_distort {true}; /// отображает искажение воздуха
 inline bool disable_heat_distort_while_lag {true}; /// выключать искажение воздуха при лагах
+inline bool enable_rotsprite_cache {true}; /// сохранять повёрнутые спрайты анимаций на диск
 inline Light_quality light_quality {Light_quality::medium}; /// качество вcпышки
 inline uint frame_skip {2};
 inline bool auto_frame_skip {true};
@@ -1,7 +1,14 @@
 #pragma once
+#include <cstdint>
+#include "util/str.hpp"
 
 namespace hpw {
 inline bool replay_read_mode {false}; /// воспроизволит реплей, иначе - записывает
 inline bool enable_replay {true}; /// включает запись реплея
+inline bool compress_replay {true}; /// сжимать блоки реплея при записи
 inline Str cur_replay_file_name {}; /// имя файла реплея, для проигрывания
+/// хэш состояний игры при проигрывании реплея (для проверки рассинхрона)
+inline std::uint64_t replay_state_hash {};
+/// первый апдейт, на котором состояние разошлось с контрольной точкой реплея (0 - не расходилось)
+inline unsigned replay_desync_tick {};
 }
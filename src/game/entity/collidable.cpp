@@ -70,6 +70,6 @@ void Collidable::sub_hp(hp_t incoming_dmg) {
 void Collidable::kill() {
   Entity::kill();
   // запустить анимацию взрыва, если она есть
-  if ( !m_explosion_name.empty())
-    hpw::entity_mgr->make(this, m_explosion_name, phys.get_pos());
+  if (m_explosion != ENTITY_PROTO_NONE)
+    hpw::entity_mgr->make(this, m_explosion, phys.get_pos());
 }
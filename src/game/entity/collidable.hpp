@@ -1,13 +1,12 @@
 #pragma once
 #include "entity.hpp"
-#include "util/str.hpp"
 
 /// Всё что способно сталкиваться и дохнуть от дамага
 class Collidable: public Entity {
   nocopy(Collidable);
   hp_t m_hp {}; /// жизни (можно сносить в минус)
   hp_t m_dmg {}; /// урон от столкновения с объектом
-  Str m_explosion_name {}; /// имя анимации взрыва
+  Entity_proto m_explosion {ENTITY_PROTO_NONE}; /// прототип взрыва
 
   void draw_hitbox(Image& dst, const Vec offset) const;
 
@@ -24,9 +23,9 @@ public:
   inline void set_dmg(hp_t val) { m_dmg = val; }
   inline hp_t get_hp() const { return m_hp; }
   inline hp_t get_dmg() const { return m_dmg; }
-  // имя взрыва
-  inline CN<Str> get_explosion_name() const { return m_explosion_name; }
-  inline void set_explosion_name(CN<Str> name) { m_explosion_name = name; }
+  // прототип взрыва
+  inline Entity_proto get_explosion() const { return m_explosion; }
+  inline void set_explosion(const Entity_proto proto) { m_explosion = proto; }
 
   Collidable();
   explicit Collidable(Entity_type new_type);
@@ -0,0 +1,143 @@
+#include <omp.h>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include "collider-grid.hpp"
+#include "game/entity/collidable.hpp"
+#include "game/entity/util/phys.hpp"
+#include "game/entity/util/hitbox.hpp"
+#include "game/entity/util/entity-util.hpp"
+#include "graphic/util/util-templ.hpp"
+#include "graphic/image/image.hpp"
+
+Collider_grid::Collider_grid(real cell_sz, std::size_t X, std::size_t Y)
+: m_cell_sz {cell_sz}
+{
+  assert(m_cell_sz > 0);
+  assert(X * Y > 0);
+  m_grid_x = std::max<int>(1, std::ceil(X / m_cell_sz));
+  m_grid_y = std::max<int>(1, std::ceil(Y / m_cell_sz));
+  m_cell_start.resize(m_grid_x * m_grid_y + 1);
+}
+
+void Collider_grid::operator()(CN<Entitys> entities, double dt) {
+  update_grid(entities);
+  update_pairs();
+  resolve_pairs(m_entities, m_pairs);
+}
+
+void Collider_grid::update_grid(CN<Entitys> entities) {
+  m_entities.clear();
+  m_items.clear();
+
+  // найти сталкиваемые объекты и их ячейки
+  for (cnauto entity_p: entities) {
+    nauto entity = *entity_p;
+    cont_if( !entity.status.collidable || !entity.status.live);
+    auto hitbox = entity.get_hitbox();
+    cont_if( !hitbox);
+
+    /* описывающий квадрат ±r вокруг simple-круга хитбокса. Круги двух объектов
+    пересекаются только если пересекаются их квадраты, поэтому пары не теряются.
+    Collider_qtree ищет грубее (целые ноды под кругом r*2), кандидатов у него
+    больше, но после точной проверки столкновения выходят те же */
+    cauto center = entity.phys.get_pos() + hitbox->simple.offset;
+    cauto r = hitbox->simple.r;
+    Item item;
+    item.lu = Vec(center.x - r, center.y - r);
+    item.rd = Vec(center.x + r, center.y + r);
+    item.cell_x0 = std::clamp<int>(std::floor(item.lu.x / m_cell_sz), 0, m_grid_x - 1);
+    item.cell_y0 = std::clamp<int>(std::floor(item.lu.y / m_cell_sz), 0, m_grid_y - 1);
+    item.cell_x1 = std::clamp<int>(std::floor(item.rd.x / m_cell_sz), 0, m_grid_x - 1);
+    item.cell_y1 = std::clamp<int>(std::floor(item.rd.y / m_cell_sz), 0, m_grid_y - 1);
+    m_items.emplace_back(item);
+    m_entities.emplace_back(entity_p);
+  }
+
+  // сортировка подсчётом: сначала сколько объектов в каждой ячейке
+  std::fill(m_cell_start.begin(), m_cell_start.end(), 0);
+  for (cnauto item: m_items)
+    for (int y = item.cell_y0; y <= item.cell_y1; ++y)
+    for (int x = item.cell_x0; x <= item.cell_x1; ++x)
+      ++m_cell_start[cell_idx(x, y) + 1];
+  // потом начало каждой ячейки
+  for (std::size_t i = 1; i < m_cell_start.size(); ++i)
+    m_cell_start[i] += m_cell_start[i - 1];
+  m_cell_items.resize(m_cell_start.back());
+  // и раскладка индексов по ячейкам (m_cell_start временно сдвигается)
+  cfor (idx, m_items.size()) {
+    cnauto item = m_items[idx];
+    for (int y = item.cell_y0; y <= item.cell_y1; ++y)
+    for (int x = item.cell_x0; x <= item.cell_x1; ++x)
+      m_cell_items[m_cell_start[cell_idx(x, y)]++] = idx;
+  }
+  // вернуть начала ячеек на место
+  for (std::size_t i = m_cell_start.size() - 1; i > 0; --i)
+    m_cell_start[i] = m_cell_start[i - 1];
+  m_cell_start[0] = 0;
+} // update_grid
+
+void Collider_grid::find_pairs(const std::uint32_t idx, Vector<Collision_pair>& dst) const {
+  cnauto self = m_items[idx];
+  nauto self_entity = *m_entities[idx];
+
+  for (int y = self.cell_y0; y <= self.cell_y1; ++y)
+  for (int x = self.cell_x0; x <= self.cell_x1; ++x) {
+    cauto cell = cell_idx(x, y);
+    for (auto i = m_cell_start[cell]; i < m_cell_start[cell + 1]; ++i) {
+      cauto other_idx = m_cell_items[i];
+      // каждая пара ищется только со стороны меньшего индекса
+      cont_if (other_idx <= idx);
+      cnauto other = m_items[other_idx];
+      /* пара из нескольких общих ячеек учитывается только в первой
+      из них, тогда повторов не будет и unordered_set не нужен */
+      cont_if (x != std::max(self.cell_x0, other.cell_x0));
+      cont_if (y != std::max(self.cell_y0, other.cell_y0));
+      // описывающие квадраты должны пересекаться
+      cont_if (self.rd.x < other.lu.x || other.rd.x < self.lu.x);
+      cont_if (self.rd.y < other.lu.y || other.rd.y < self.lu.y);
+      // проверить на возможность сталкиваться по флагам
+      cont_if (!cld_flag_compat(self_entity, *m_entities[other_idx]));
+      dst.emplace_back(idx, other_idx);
+    }
+  } // for cells
+} // find_pairs
+
+void Collider_grid::update_pairs() {
+  m_pairs.clear();
+
+#ifdef _OPENMP
+  // у каждого потока свой список пар
+  cauto th_max = omp_get_max_threads();
+  assert(th_max > 0);
+  m_thread_pairs.resize(th_max);
+  for (nauto list: m_thread_pairs)
+    list.clear();
+
+  #pragma omp parallel for schedule(dynamic, 64)
+  cfor (idx, m_items.size())
+    find_pairs(idx, m_thread_pairs[omp_get_thread_num()]);
+
+  // объединение списков с потоков, порядок потом выправит сортировка
+  for (cnauto list: m_thread_pairs)
+    m_pairs.insert(m_pairs.end(), list.begin(), list.end());
+
+#else // вариант без многопотока
+  cfor (idx, m_items.size())
+    find_pairs(idx, m_pairs);
+#endif
+} // update_pairs
+
+void Collider_grid::debug_draw(Image& dst, const Vec camera_offset) {
+  const Pal8 grid_color = Pal8::white;
+  cauto w = m_grid_x * m_cell_sz;
+  cauto h = m_grid_y * m_cell_sz;
+  for (int x = 1; x < m_grid_x; ++x)
+    draw_line<&blend_diff>(dst,
+      camera_offset + Vec(x * m_cell_sz, 0),
+      camera_offset + Vec(x * m_cell_sz, h), grid_color);
+  for (int y = 1; y < m_grid_y; ++y)
+    draw_line<&blend_diff>(dst,
+      camera_offset + Vec(0, y * m_cell_sz),
+      camera_offset + Vec(w, y * m_cell_sz), grid_color);
+}
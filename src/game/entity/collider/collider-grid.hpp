@@ -0,0 +1,47 @@
+#pragma once
+#include "collider.hpp"
+
+/** Нахождение столкновений через равномерную сетку.
+Хорошо подходит для кучи мелких объектов одного размера (пули) */
+class Collider_grid final: public Collider {
+  nocopy(Collider_grid);
+
+  /// объект в сетке
+  struct Item {
+    Vec lu {}; /// левый верхний угол описывающего квадрата
+    Vec rd {}; /// правый нижний угол описывающего квадрата
+    int cell_x0 {}, cell_y0 {}; /// первая ячейка, которую задевает объект
+    int cell_x1 {}, cell_y1 {}; /// последняя ячейка, которую задевает объект
+  };
+
+  real m_cell_sz {}; /// размер ячейки в пикселях
+  int m_grid_x {}; /// ширина сетки в ячейках
+  int m_grid_y {}; /// высота сетки в ячейках
+  Entitys m_entities {}; /// объекты пригодные к сталкиванию, на них ссылаются пары
+  Vector<Item> m_items {}; /// описание объектов в сетке, индексы как в m_entities
+  Vector<uint> m_cell_start {}; /// с какого элемента m_cell_items начинается ячейка
+  Vector<std::uint32_t> m_cell_items {}; /// индексы объектов, сгруппированные по ячейкам
+  Vector< Vector<Collision_pair> > m_thread_pairs {}; /// найденные пары в каждом потоке
+  Vector<Collision_pair> m_pairs {}; /// все пары для проверок
+
+  /// фильтрует объекты и раскладывает их по ячейкам
+  void update_grid(CN<Entitys> entities);
+  /// находит пары объектов из одних и тех же ячеек
+  void update_pairs();
+  /// добавляет в dst пары для объекта с индексом idx
+  void find_pairs(const std::uint32_t idx, Vector<Collision_pair>& dst) const;
+  /// индекс ячейки
+  inline std::size_t cell_idx(const int x, const int y) const
+    { return scast<std::size_t>(y) * m_grid_x + x; }
+
+public:
+  /** за пределами области сетки объекты попадают в крайние ячейки
+  * @param cell_sz размер ячейки, лучше брать чуть больше диаметра пули
+  * @param X ширина пространства
+  * @param Y высота пространства */
+  explicit Collider_grid(real cell_sz, std::size_t X, std::size_t Y);
+  ~Collider_grid() = default;
+  void operator()(CN<Entitys> entities, double dt) override;
+  /// рисует сетку для дебага
+  void debug_draw(Image& dst, const Vec camera_offset) override;
+}; // Collider_grid
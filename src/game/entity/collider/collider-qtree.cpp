@@ -20,9 +20,15 @@
 /// память под ветви
 static Mem_pool qtree_mempool;
 
+/// объект в ноде дерева
+struct Qtree_item {
+  Entity* entity {};
+  std::uint32_t idx {}; /// индекс объекта в списке сталкиваемых
+};
+
 /// quad-tree односвязное дерево
 class Qtree final {
-  Vector<Entity*> m_entitys {}; /// список объектов в текущей ноде
+  Vector<Qtree_item> m_entitys {}; /// список объектов в текущей ноде
   Pool_ptr(Qtree) lu {}; /// лево верх
   Pool_ptr(Qtree) ru {}; /// право верх
   Pool_ptr(Qtree) ld {}; /// лево низ
@@ -72,7 +78,8 @@ public:
   }
 
   /// добавить объект в систему
-  inline void add(Entity& entity) {
+  inline void add(const Qtree_item item) {
+    nauto entity = *item.entity;
     // если есть ветви, то записываем объекы в них
     if (have_branches) {
       auto pos_x = std::floor(entity.phys.get_pos().x);
@@ -81,19 +88,19 @@ public:
       // верх
       if (pos_y >= bound.pos.y && pos_y < bound.pos.y + (bound.size.y / 2.0)) {
         if (pos_x >= bound.pos.x && pos_x < bound.pos.x + (bound.size.x / 2.0))
-          lu->add(entity); // лево
+          lu->add(item); // лево
         else
-          ru->add(entity); // право
+          ru->add(item); // право
       } else { // низ
         if (pos_x >= bound.pos.x && pos_x < bound.pos.x + (bound.size.x / 2.0))
-          ld->add(entity); // лево
+          ld->add(item); // лево
         else
-          rd->add(entity); // право
+          rd->add(item); // право
       }
     } else { // если ветвей нет:
       // добавить объект, если есть свободное место
       if (m_entitys.size() < entity_limit) {
-        m_entitys.emplace_back(&entity);
+        m_entitys.emplace_back(item);
       } else { // при отстуствии свободного места:
         // если размер вставляемого объекта больше сектора, то не делить пространство
         auto hithox = entity.get_hitbox();
@@ -102,15 +109,15 @@ public:
           std::abs(hithox->simple.offset.x) + hithox->simple.r > bound.size.x / 2.0 ||
           std::abs(hithox->simple.offset.y) + hithox->simple.r > bound.size.y / 2.0
         ) {
-          m_entitys.emplace_back(&entity);
+          m_entitys.emplace_back(item);
           return;
         }
         // поделиться на 4 части, если глубина меньше лимита объектов в ноде
         if (depth < max_depth) {
           split();
-          add(entity); // добавить что хотели в следующие ветви
+          add(item); // добавить что хотели в следующие ветви
         } else { // не делиться больше, добавить объект
-          m_entitys.emplace_back(&entity);
+          m_entitys.emplace_back(item);
         }
       } // else m_entitys.size() >= entity_limit
     } // if not have_branches
@@ -129,8 +136,8 @@ public:
     ld = qtree_mempool.new_object<Qtree>(ld_rect, depth + 1, max_depth, entity_limit);
     rd = qtree_mempool.new_object<Qtree>(rd_rect, depth + 1, max_depth, entity_limit);
     // перенос объектов из ветки выше в новые
-    for (nauto entity: m_entitys)
-      add(*entity);
+    for (cnauto item: m_entitys)
+      add(item);
     m_entitys.clear();
   } // split
 
@@ -160,7 +167,7 @@ public:
   } // draw
 
   /// найти соседей в области area
-  inline void find(CN<Circle> area, Vector<Entity*>& list) const {
+  inline void find(CN<Circle> area, Vector<Qtree_item>& list) const {
     if (intersect(this->bound, area)) {
       // так быстрее, чем std::copy или list.insert
       for (cnauto en: m_entitys)
@@ -209,39 +216,20 @@ std::size_t X, std::size_t Y)
 {}
 
 void Collider_qtree::operator()(CN<Entitys> entities, double dt) {
-  auto filtered_entitys = update_qtree(entities);
-  update_pairs(filtered_entitys);
-
-  // перегонка unordered_set в vector, чтобы через omp можно было распараллелить:
-  Vector<Collision_pair> tmp_pairs(collision_pairs.begin(), collision_pairs.end());
-  #pragma omp parallel for schedule(dynamic, 4)
-  cfor (i, tmp_pairs.size()) {
-    cnauto pair = tmp_pairs[i];
-    test_collide_pair(*pair.first, *pair.second);
-  }
-}
+  update_qtree(entities);
+  update_pairs();
 
-void Collider_qtree::test_collide_pair(Entity& a, Entity& b) {
-  // объектыs что сюда попадут, точно можно будет сталкивать
-  nauto a_collidable = *(ptr2ptr<Collidable*>(&a));
-  nauto b_collidable = *(ptr2ptr<Collidable*>(&b));
-  // обновление флага столкновений
-  cauto collided = a_collidable.is_collided_with(b_collidable);
-  // снести хп
-  if (collided) {
-    a_collidable.status.collided |= collided;
-    a_collidable.sub_hp( b_collidable.get_dmg() );
-    b_collidable.status.collided |= collided;
-    b_collidable.sub_hp( a_collidable.get_dmg() );
-  }
-}
+  // перегонка unordered_set в vector, чтобы через omp можно было распараллелить
+  sorted_pairs.assign(collision_pairs.begin(), collision_pairs.end());
+  resolve_pairs(m_entities, sorted_pairs);
+} // op ()
 
 void Collider_qtree::debug_draw(Image& dst, const Vec camera_offset) {
   root->draw(dst, camera_offset);
 }
 
-Entitys Collider_qtree::update_qtree(CN<Entitys> entities) {
-  Entitys ret; /// объекты пригодные к сталкиванию
+void Collider_qtree::update_qtree(CN<Entitys> entities) {
+  m_entities.clear(); /// объекты пригодные к сталкиванию
 
   #ifdef ECOMEM
     // сбросить листы в дереве
@@ -260,15 +248,27 @@ Entitys Collider_qtree::update_qtree(CN<Entitys> entities) {
     nauto entity = *entity_p;
     // проверить что объект может сталкиваться и что он жив
     if (entity.status.collidable && entity.status.live) {
-      root->add(entity);
-      ret.emplace_back(entity_p);
+      root->add( Qtree_item{.entity = &entity, .idx = scast<std::uint32_t>(m_entities.size())} );
+      m_entities.emplace_back(entity_p);
     }
   }
-
-  return ret;
 } // update_qtree
 
-void Collider_qtree::update_pairs(CN<Entitys> entities) {
+/// добавить пару в список проверок, если объекты могут сталкиваться
+template <class Set>
+inline static void add_pair(Set& dst, const Qtree_item a, const Qtree_item b) {
+  // сами себя не проверяем
+  return_if (a.idx == b.idx);
+  // проверить на возможность сталкиваться по флагам
+  return_if (!cld_flag_compat(*a.entity, *b.entity));
+  // меньший индекс всегда первый, тогда одинаковые пары совпадут
+  if (a.idx < b.idx)
+    dst.emplace(a.idx, b.idx);
+  else
+    dst.emplace(b.idx, a.idx);
+}
+
+void Collider_qtree::update_pairs() {
   collision_pairs.clear();
 
 #ifdef _OPENMP
@@ -277,7 +277,7 @@ void Collider_qtree::update_pairs(CN<Entitys> entities) {
   assert(th_max > 0);
   // для хранения локальных списков в потоках
   static Vector<decltype(collision_pairs)> list_table;
-  static Vector< Vector<Entity*> > lists;
+  static Vector< Vector<Qtree_item> > lists;
   list_table.resize(th_max);
   for (nauto table: list_table)
     table.clear();
@@ -288,7 +288,8 @@ void Collider_qtree::update_pairs(CN<Entitys> entities) {
   #pragma omp parallel for \
     schedule(dynamic) \
     shared(root, list_table)
-  for (nauto entity: entities) {
+  cfor (idx, m_entities.size()) {
+    nauto entity = m_entities[idx];
     auto hitbox = entity->get_hitbox();
     cont_if(!hitbox);
     // узнать какой сейчас поток
@@ -301,43 +302,23 @@ void Collider_qtree::update_pairs(CN<Entitys> entities) {
     root->find(area, lists[th_idx]);
 
     // добавить этих соседей в пары на проверки
-    for (nauto other: lists[th_idx]) {
-      auto addr_a = entity.get();
-      auto addr_b = other;
-      // сами себя не проверяем
-      cont_if (addr_a == addr_b);
-      // проверить на возможность сталкиваться по флагам
-      cont_if (!cld_flag_compat(*addr_a, *addr_b));
-      // эта перестановка сократит число одинаsковых пар
-      if (addr_b > addr_a)
-        std::swap(addr_a, addr_b);
-      // unordered_set сам уберёт повторы
-      list_table.at(th_idx).emplace(addr_a, addr_b);
-    } // for list
+    const Qtree_item self {.entity = entity.get(), .idx = scast<std::uint32_t>(idx)};
+    for (cnauto other: lists[th_idx])
+      add_pair(list_table[th_idx], self, other);
   } // for entities
 
   // объединение листов с потоков в релизный collision_pairs
-  for (cnauto table: list_table) {
-    for (nauto it: table) {
-      auto addr_a = it.first;
-      auto addr_b = it.second;
-      // сами себя не проверяем
-      cont_if (addr_a == addr_b);
-      // проверить на возможность сталкиваться по флагам
-      cont_if (!cld_flag_compat(*addr_a, *addr_b));
-      // эта перестановка сократит число одинаковых пар
-      if (addr_b > addr_a)
-        std::swap(addr_a, addr_b);
-      // unordered_set сам уберёт повторы
-      collision_pairs.emplace( std::move(it) );
-    } // for table
-  } // for list_table
+  for (cnauto table: list_table)
+    for (cnauto it: table)
+      collision_pairs.emplace(it); // unordered_set сам уберёт повторы
 
 #else // вариант без многопотока
 
   /* проверить области вокруг каждой точки и закинуть в пару
   коллизии соседние ноды входящие в область */
-  for (nauto entity: entities) {
+  Vector<Qtree_item> list;
+  cfor (idx, m_entities.size()) {
+    nauto entity = m_entities[idx];
     auto hitbox = entity->get_hitbox();
     cont_if(!hitbox);
     auto pos = entity->phys.get_pos();
@@ -346,23 +327,13 @@ void Collider_qtree::update_pairs(CN<Entitys> entities) {
     Circle area(pos + hitbox->simple.offset, hitbox->simple.r * 2);
     
     // найти соседей к этой точке
-    Vector<Entity*> list;
+    list.clear();
     root->find(area, list);
 
     // добавить этих соседей в пары на проверки
-    for (nauto other: list) {
-      auto addr_a = entity.get();
-      auto addr_b = other;
-      // сами себя не проверяем
-      cont_if (addr_a == addr_b);
-      // проверить на возможность сталкиваться по флагам
-      cont_if (!cld_flag_compat(*addr_a, *addr_b));
-      // эта перестановка сократит число одинаковых пар
-      if (addr_b > addr_a)
-        std::swap(addr_a, addr_b);
-      // unordered_set сам уберёт повторы
-      collision_pairs.emplace(addr_a, addr_b);
-    } // for list
+    const Qtree_item self {.entity = entity.get(), .idx = scast<std::uint32_t>(idx)};
+    for (cnauto other: list)
+      add_pair(collision_pairs, self, other);
   } // for entities
 
 #endif
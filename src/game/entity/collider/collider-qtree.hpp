@@ -1,11 +1,11 @@
 #pragma once
 #include <cstdint>
 #include <utility>
-#include <bit>
 #include "robin-hood-hashing/robin_hood.h"
 #include "util/mempool.hpp"
 #include "util/platform.hpp"
 #include "util/math/num-types.hpp"
+#include "util/math/random.hpp"
 #include "collider.hpp"
 
 class Entity;
@@ -15,33 +15,33 @@ class Qtree;
 class Collider_qtree final: public Collider {
   nocopy(Collider_qtree);
   Pool_ptr(Qtree) root {}; /// старт дерева
+  Entitys m_entities {}; /// объекты пригодные к сталкиванию, на них ссылаются пары
 
-  /// проверка хитбоксов на пересечения
-  void test_collide_pair(Entity& a, Entity& b);
   /// фильтрует список объектов для проверки по возможности сталкиваться
-  Entitys update_qtree(CN<Entitys> entities);
+  void update_qtree(CN<Entitys> entities);
   /// обновляет список пар столкновений
-  void update_pairs(CN<Entitys> entities);
+  void update_pairs();
 
 public:
-  using Collision_pair = std::pair<Entity*, Entity*>;
-
   /// хешер для collision_pairs
   struct Collision_pairs_hash {
     inline static std::size_t operator()(const Collision_pair val) {
-      // сделать поинтеры числом и юзать это как уникальный ID
-      cauto a = std::bit_cast<std::uintptr_t>(val.first);
-      cauto b = std::bit_cast<std::uintptr_t>(val.second);
+      // два индекса без потерь влезают в одно 64-битное число
+      cauto key = (std::uint64_t(val.first) << 32) | val.second;
       #ifdef is_x32
-        return (a << 15) + b;
+        // в 32 бита: перемешать и сложить обе половины, чтобы first не терялся
+        cauto mixed = rnd_mix64(key);
+        return std::size_t(mixed ^ (mixed >> 32));
       #else
-        return (a << 31) + b;
+        return key;
       #endif
     }
   };
 
   /// список пар для проверок
   robin_hood::unordered_set<Collision_pair, Collision_pairs_hash> collision_pairs {};
+  /// пары из collision_pairs в виде массива для resolve_pairs
+  Vector<Collision_pair> sorted_pairs {};
   /** за пределами области QTree, пересечения объектов не будут находится
   * @param depth сколько раз можно делить пространство
   * @param entity_limit сколько должно быть объектов в секторе, чтобы начать деление
@@ -0,0 +1,15 @@
+#include "collider-util.hpp"
+#include "collider-qtree.hpp"
+#include "collider-grid.hpp"
+#include "collider-simple.hpp"
+#include "util/error.hpp"
+
+Shared<Collider> make_collider(std::size_t X, std::size_t Y) {
+  switch (hpw::collider_type) {
+    case Collider_type::qtree: return new_shared<Collider_qtree>(6, 1, X, Y);
+    case Collider_type::grid: return new_shared<Collider_grid>(32, X, Y);
+    case Collider_type::simple: return new_shared<Collider_simple>();
+  }
+  error("неизвестный тип обработчика столкновений " << scast<int>(hpw::collider_type));
+  return {};
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include "util/mem-types.hpp"
+
+class Collider;
+
+/// какой обработчик столкновений ставить на уровнях
+enum class Collider_type {
+  qtree = 0, /// Collider_qtree
+  grid, /// Collider_grid
+  simple, /// Collider_simple
+};
+
+namespace hpw {
+inline Collider_type collider_type {Collider_type::qtree};
+}
+
+/** создать обработчик столкновений по hpw::collider_type
+* @param X ширина пространства
+* @param Y высота пространства */
+Shared<Collider> make_collider(std::size_t X, std::size_t Y);
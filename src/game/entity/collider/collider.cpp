@@ -0,0 +1,41 @@
+#include <omp.h>
+#include <algorithm>
+#include "collider.hpp"
+#include "game/entity/collidable.hpp"
+
+void Collider::resolve_pairs(CN<Entitys> entities, Vector<Collision_pair>& pairs) {
+  // сортировка нужна для стабильного порядка применения урона
+  std::sort(pairs.begin(), pairs.end());
+  m_pair_results.resize(pairs.size());
+
+  // поиск столкновений, объекты здесь не меняются
+  #pragma omp parallel for schedule(dynamic, 4)
+  cfor (i, pairs.size()) {
+    cnauto pair = pairs[i];
+    m_pair_results[i] = test_collide_pair(*entities[pair.first], *entities[pair.second]);
+  }
+
+  // применение урона в одном потоке
+  cfor (i, pairs.size()) {
+    cont_if( !m_pair_results[i]);
+    cnauto pair = pairs[i];
+    apply_collide_pair(*entities[pair.first], *entities[pair.second]);
+  }
+} // resolve_pairs
+
+bool Collider::test_collide_pair(CN<Entity> a, CN<Entity> b) {
+  // объекты что сюда попадут, точно можно будет сталкивать
+  cnauto a_collidable = *(cptr2ptr<CP<Collidable>>(&a));
+  cnauto b_collidable = *(cptr2ptr<CP<Collidable>>(&b));
+  return a_collidable.is_collided_with(b_collidable);
+}
+
+void Collider::apply_collide_pair(Entity& a, Entity& b) {
+  nauto a_collidable = *(ptr2ptr<Collidable*>(&a));
+  nauto b_collidable = *(ptr2ptr<Collidable*>(&b));
+  // обновление флага столкновений и снос хп
+  a_collidable.status.collided = true;
+  a_collidable.sub_hp( b_collidable.get_dmg() );
+  b_collidable.status.collided = true;
+  b_collidable.sub_hp( a_collidable.get_dmg() );
+}
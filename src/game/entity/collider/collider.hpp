@@ -1,13 +1,32 @@
 #pragma once
+#include <cstdint>
+#include <utility>
 #include "game/entity/entity-type.hpp"
 #include "util/macro.hpp"
 #include "util/math/vec.hpp"
+#include "util/math/num-types.hpp"
 
 class Image;
 
 /// ресолвер коллизий (база)
 class Collider {
   nocopy(Collider);
+  Vector<byte> m_pair_results {}; /// результаты проверок для resolve_pairs
+
+  /// проверка хитбоксов на пересечения (только чтение, можно из потоков)
+  static bool test_collide_pair(CN<Entity> a, CN<Entity> b);
+  /// применить урон от столкновения
+  static void apply_collide_pair(Entity& a, Entity& b);
+
+protected:
+  /// индексы пары объектов в списке сталкиваемых (first < second)
+  using Collision_pair = std::pair<std::uint32_t, std::uint32_t>;
+
+  /** проверяет пары в потоках, а урон применяет в одном потоке в порядке
+  сортировки пар. Так результат не зависит от числа потоков
+  @param entities объекты, на которые ссылаются индексы в pairs
+  @param pairs список пар, будет отсортирован */
+  void resolve_pairs(CN<Entitys> entities, Vector<Collision_pair>& pairs);
 
 public:
   Collider() = default;
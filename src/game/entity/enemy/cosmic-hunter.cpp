@@ -29,7 +29,7 @@ void Cosmic_hunter::update(double dt) {
   phys.set_invert_rotation( !rot_to_right);
 
   cfor (_, m_info.shoot_timer.update(dt)) {
-    auto bullet = hpw::entity_mgr->make(this, m_info.bullet_name, phys.get_pos());
+    auto bullet = hpw::entity_mgr->make(this, m_info.bullet, phys.get_pos());
     bullet->phys.set_speed(m_info.bullet_speed);
     bullet->status.ignore_scatter = true;
 
@@ -65,12 +65,13 @@ struct Cosmic_hunter::Loader::Impl {
     m_info.rotate_speed = pps( config.get_real("rotate_speed") );
     m_info.bullet_speed = pps( config.get_real("bullet_speed") );
     m_info.shoot_deg = config.get_real("shoot_deg");
-    m_info.bullet_name = config.get_str("bullet_name");
+    cauto bullet_name = config.get_str("bullet_name");
+    assert( !bullet_name.empty());
+    m_info.bullet = hpw::entity_mgr->find_proto(bullet_name);
     
     assert(m_info.bullet_speed > 0);
     assert(m_info.rotate_speed > 0);
     assert(m_info.speed > 0);
-    assert( !m_info.bullet_name.empty());
   } // c-tor
 
   inline Entity* operator()(Entity* master, const Vec pos, Entity* parent) {
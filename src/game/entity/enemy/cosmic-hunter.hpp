@@ -1,7 +1,6 @@
 #pragma once
 #include "game/entity/enemy/proto-enemy.hpp"
 #include "util/math/timer.hpp"
-#include "util/str.hpp"
 
 /// Простой противник стреляющий на упреждение в игрока
 class Cosmic_hunter final: public Proto_enemy {
@@ -13,7 +12,7 @@ class Cosmic_hunter final: public Proto_enemy {
     real bullet_speed {};
     real shoot_deg {}; /// разброс пуль
     real speed {};
-    Str bullet_name {};
+    Entity_proto bullet {ENTITY_PROTO_NONE};
   } m_info {};
   
 public:
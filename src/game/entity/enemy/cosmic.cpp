@@ -69,28 +69,9 @@ void Cosmic::update(double dt) {
   return_if( !m_eyes_open_complete);
 
   // стрелять в игрока
-  cauto player = hpw::entity_mgr->get_player();
-  assert(player);
-  cfor (_, m_info.shoot_timer.update(dt)) {
-    cfor (_, m_info.bullet_count) {
-      cauto spawn_pos = phys.get_pos() + (rand_normalized_stable() *
-        m_info.bullet_spawn_range);
-      auto bullet = hpw::entity_mgr->make(this, m_info.bullet, spawn_pos);
-      bullet->phys.set_speed(m_info.bullet_predict_speed);
-
-      // либо стрелять в игрока, либо на упреждение
-      real deg;
-      if (rndb() & 1)
-        deg = deg_to_target(*bullet, predict(*bullet, *player, dt) );
-      else
-        deg = deg_to_target(*bullet, hpw::entity_mgr->target_for_enemy());
-      bullet->phys.set_deg(deg);
-
-      bullet->phys.set_accel(m_info.bullet_accel);
-      bullet->phys.set_speed(m_info.bullet_speed);
-      bullet->status.ignore_scatter = true;
-    }
-  }
+  m_shoot.update(*this, dt);
+  cfor (_, m_info.shoot_timer.update(dt))
+    m_shoot.start(m_info.shoot_pattern, *this, dt);
 } // update
 
 void Cosmic::update_magnet() {
@@ -122,7 +103,7 @@ void Cosmic::make_particles(double dt) {
         // сдвиг по горизонтали каждую нечётную строку, чтобы были соты, а не сетка
         (x + ((y & 1) ? 0 : 0.5)) * (w / X),
         y * (h / Y) );
-      hpw::entity_mgr->make(this, "particle.blink.star", pos);
+      hpw::entity_mgr->make(this, m_info.particle, pos);
     } // for y x
   } // for particle_timer
 }
@@ -130,6 +111,26 @@ void Cosmic::make_particles(double dt) {
 struct Cosmic::Loader::Impl {
   Info m_info {};
 
+  /// старый формат конфига: стрельба задана полями bullet_*
+  inline static Bullet_pattern load_legacy_pattern(CN<Yaml> config) {
+    Bullet_volley volley;
+    cauto bullet_name = config.get_str("bullet");
+    assert( !bullet_name.empty());
+    volley.bullet = hpw::entity_mgr->find_proto(bullet_name);
+    volley.count = config.get_int("bullet_count");
+    volley.aim = Pattern_aim::target_or_predict;
+    volley.spawn_range = config.get_real("bullet_spawn_range");
+    volley.speed_min = volley.speed_max = pps( config.get_real("bullet_speed") );
+    volley.predict_speed = pps( config.get_real("bullet_predict_speed") );
+    volley.accel = pps( config.get_real("bullet_accel") );
+    volley.ignore_scatter = true;
+
+    assert(volley.count > 0);
+    assert(volley.speed_max > 0);
+    assert(volley.predict_speed > 0);
+    return Bullet_pattern { .volleys {volley} };
+  }
+
   inline explicit Impl(CN<Yaml> config) {
     cauto animations = config.get_v_str("animations");
     m_info.state_1 = hpw::anim_mgr->find_anim(animations.at(0)).get();
@@ -142,22 +143,19 @@ struct Cosmic::Loader::Impl {
     m_info.particle_timer = Timer( config.get_real("particle_timer") );
     m_info.magnet_range = config.get_real("magnet_range");
     m_info.magnet_power = pps( config.get_real("magnet_power") );
-    m_info.bullet_spawn_range = config.get_real("bullet_spawn_range");
-    m_info.bullet_speed = pps( config.get_real("bullet_speed") );
-    m_info.bullet_accel = pps( config.get_real("bullet_accel") );
-    m_info.bullet_predict_speed = pps( config.get_real("bullet_predict_speed") );
-    m_info.bullet = config.get_str("bullet");
+    m_info.particle = hpw::entity_mgr->find_proto("particle.blink.star");
     m_info.heat_distort = load_heat_distort(config["heat_distort"]);
-    m_info.bullet_count = config.get_int("bullet_count");
+    // паттерн из config/bullet-patterns.yml, без него - из полей bullet_*
+    cauto pattern_name = config.get_str("shoot_pattern",
+      "enemy.cosmic.shoot." + config.get_str("bullet"));
+    m_info.shoot_pattern = hpw::entity_mgr->find_pattern(pattern_name);
+    if (hpw::entity_mgr->get_pattern(m_info.shoot_pattern).empty())
+      hpw::entity_mgr->set_pattern(m_info.shoot_pattern, load_legacy_pattern(config));
 
     assert(m_info.state_1);
     assert(m_info.state_2);
-    assert(m_info.bullet_count > 0);
     assert(m_info.magnet_range > 0);
     assert(m_info.magnet_power > 0);
-    assert(m_info.bullet_speed > 0);
-    assert(m_info.bullet_predict_speed > 0);
-    assert( !m_info.bullet.empty());
   } // c-tor
 
   inline Entity* operator()(Entity* master, const Vec pos, Entity* parent) {
@@ -1,7 +1,7 @@
 #pragma once
 #include "game/entity/enemy/proto-enemy.hpp"
 #include "util/math/timer.hpp"
-#include "util/str.hpp"
+#include "game/entity/util/bullet-pattern.hpp"
 #include "graphic/effect/heat-distort.hpp"
 
 class Anim;
@@ -20,15 +20,13 @@ class Cosmic final: public Proto_enemy {
     Timer particle_timer {}; /// таймер появления частиц для показа гравитации
     real magnet_range {};
     real magnet_power {};
-    real bullet_spawn_range {};
-    real bullet_speed {};
-    real bullet_accel {};
-    real bullet_predict_speed {}; /// начальная скорость пули для предикта
-    Str bullet {};
+    Pattern_id shoot_pattern {PATTERN_NONE}; /// чем стрелять по таймеру
+    Entity_proto particle {ENTITY_PROTO_NONE}; /// частицы гравитации
     Heat_distort heat_distort {};
-    int bullet_count {}; /// сколько пустить пуль за выстрел
   } m_info {};
 
+  Pattern_runner m_shoot {};
+
   bool m_fade_in_complete {false};
   bool m_eyes_open_complete {false};
 
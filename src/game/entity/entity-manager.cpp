@@ -1,5 +1,7 @@
 #include <cassert>
 #include <unordered_map>
+#include <filesystem>
+#include <functional>
 #include "entity-manager.hpp"
 #include "entity-type.hpp"
 #include "particle-loader.hpp"
@@ -20,6 +22,8 @@
 #include "game/util/game-util.hpp"
 #include "game/core/time-scale.hpp"
 #include "game/core/core.hpp"
+#include "game/core/common.hpp"
+#include "game/core/debug.hpp"
 #include "game/core/canvas.hpp"
 #include "game/entity/util/scatter.hpp"
 #include "game/entity/util/entity-util.hpp"
@@ -40,12 +44,21 @@ struct Entity_mgr::Impl {
   Mem_pool entity_pool {}; /// мем-пул под объекты
   Mem_pool phys_pool {}; /// мем-пул под физические контексты
   Mem_pool hitbox_pool {}; /// мем-пул под хитбоксы
-  /// БД инициализаторов объектов
-  std::unordered_map<Str, Shared<Entity_loader>> entity_loaders {};
+  /// БД инициализаторов объектов, индекс - Entity_proto
+  Vector<Shared<Entity_loader>> entity_loaders {};
+  Strs proto_names {}; /// имена прототипов по Entity_proto
+  std::unordered_map<Str, Entity_proto> proto_table {}; /// имя -> Entity_proto
+  Vector<Bullet_pattern> patterns {}; /// паттерны пуль, индекс - Pattern_id
+  std::unordered_map<Str, Pattern_id> pattern_table {}; /// имя -> Pattern_id
   Vector<Scatter> scatters {}; /// источники взрывных волн
   Entitys registrate_list {};
+  /// мёртвые объекты по типам, готовые к переиспользованию
+  std::unordered_map<Entity_type, Vector<Entity*>> free_entities {};
+  /// умершие за кадр, в конце кадра уходят в free_entities
+  Vector<Entity*> killed_list {};
   /// текущая ссылка на игрока, чтобы враги могли брать его в таргет
   Player* m_player {};
+  bool types_registered {false}; /// был ли вызван register_types
 
   inline Impl() {
     #ifndef ECOMEM
@@ -75,8 +88,10 @@ struct Entity_mgr::Impl {
     accept_registrate_list();
     update_scatters();
     update_entitys(dt);
-    if (collision_resolver)
-      (*collision_resolver)(entities, dt);
+    if (collision_resolver) {
+      hpw::profiled_call(hpw::update_profile.collisions,
+        [&] { (*collision_resolver)(entities, dt); });
+    }
     bound_check();
     update_kills();
   } // update
@@ -112,6 +127,8 @@ struct Entity_mgr::Impl {
     collision_resolver = {};
     m_player = {};
     entities.clear();
+    free_entities.clear();
+    killed_list.clear();
     entity_pool.release();
     phys_pool.release();
     hitbox_pool.release();
@@ -119,16 +136,23 @@ struct Entity_mgr::Impl {
 
   inline void update_entitys(double dt) {
     assert(hpw::time_scale > 0);
+    // изменять время для игрока и его объектов
+    auto entity_dt = [&](CN<Entity> entity) {
+      cauto player = get_player();
+      if (&entity == player || entity.master == player)
+        return dt / hpw::time_scale;
+      return dt; // все остальные сущности
+    };
+
+    // сначала движение всех живых объектов одним проходом по массивам Phys
+    for (cnauto entity: entities)
+      if (entity->status.live)
+        entity->phys.plan_update(entity_dt(*entity));
+    Phys::update_planned();
 
     for (nauto entity: entities) {
-      if (entity->status.live) {
-        // изменять время для игрока и его объектов
-        cauto player = get_player();
-        if (entity.get() == player || entity->master == player)
-          entity->update(dt / hpw::time_scale);
-        else // все остальные сущности
-          entity->update(dt);
-      }
+      if (entity->status.live)
+        entity->update(entity_dt(*entity));
     } // if live
   } // update_entitys
 
@@ -149,9 +173,23 @@ struct Entity_mgr::Impl {
       }
     } // for entities
 
+    update_free_entities();
     // TODO чистка в ECOMEM
   } // update_kills
 
+  /** отдать умерших за кадр в списки мёртвых объектов. До конца кадра
+  они не переиспользуются, чтобы kill-колбэки видели объект целым */
+  inline void update_free_entities() {
+    for (cauto entity: killed_list)
+      free_entities[entity->type].push_back(entity);
+    killed_list.clear();
+  }
+
+  inline void on_kill(Entity* entity) {
+    assert(entity);
+    killed_list.push_back(entity);
+  }
+
   inline void debug_draw(Image& dst) const
     { collision_resolver->debug_draw(dst, {}/* camera TODO */); }
 
@@ -163,7 +201,7 @@ struct Entity_mgr::Impl {
   inline Shared<Entity_loader> make_entity_loader(CN<Str> type, CN<Yaml> config) {
     // регистрация загрузчиков объектов
     using Maker = std::function< Shared<Entity_loader> (CN<Yaml>) >;
-    std::unordered_map<Str, Maker> table {
+    sconst std::unordered_map<Str, Maker> table {
       {"explosion", [](CN<Yaml> config){ return new_shared<Explosion_loader>(config); } },
       {"bonus", [](CN<Yaml> config){ return new_shared<Bonus_loader>(config); } },
       {"bullet", [](CN<Yaml> config){ return new_shared<Bullet_loader>(config); } },
@@ -186,7 +224,11 @@ struct Entity_mgr::Impl {
   } // make_entity_loader
 
   inline void register_types() {
-    entity_loaders.clear();
+    // id прототипов остаются прежними, сбрасываются только загрузчики
+    for (nauto loader: entity_loaders)
+      loader = {};
+    // паттерны раньше объектов: загрузчики берут их id и дополняют недостающие
+    load_patterns();
 
     #ifndef ECOMEM // при экономии памяти объекты подгружаются в момент вызова
       // загрузить все объекты из конфига
@@ -194,52 +236,102 @@ struct Entity_mgr::Impl {
       for (cnauto entity_name: config.root_tags()) {
         auto entity_node = config[entity_name];
         auto type = entity_node.get_str("type", "error type");
-        entity_loaders[entity_name] = make_entity_loader(type, entity_node);
+        // загрузчик может сам запросить прототипы, поэтому id берётся после
+        auto loader = make_entity_loader(type, entity_node);
+        entity_loaders[find_proto(entity_name)] = loader;
       }
+      types_registered = true;
     #endif
   } // register_types
 
-  inline Entity* load_unknown_entity(Entity* master, CN<Str> name, const Vec pos) {
+  inline Entity_proto find_proto(CN<Str> name) {
+    if (auto it = proto_table.find(name); it != proto_table.end())
+      return it->second;
+
+    // новый прототип, загрузчик для него появится в register_types
+    const Entity_proto proto = proto_names.size();
+    iferror(proto == ENTITY_PROTO_NONE, "слишком много прототипов объектов");
+    proto_names.emplace_back(name);
+    entity_loaders.emplace_back();
+    proto_table[name] = proto;
+    return proto;
+  }
+
+  inline Pattern_id find_pattern(CN<Str> name) {
+    if (auto it = pattern_table.find(name); it != pattern_table.end())
+      return it->second;
+
+    // новый паттерн, его содержимое появится в load_patterns или set_pattern
+    const Pattern_id pattern = patterns.size();
+    iferror(pattern == PATTERN_NONE, "слишком много паттернов пуль");
+    patterns.emplace_back();
+    pattern_table[name] = pattern;
+    return pattern;
+  }
+
+  inline void load_patterns() {
+    // id паттернов остаются прежними, сбрасывается только содержимое
+    for (nauto pattern: patterns)
+      pattern = {};
+
+    #ifdef EDITOR
+      cauto path = hpw::cur_dir + "config/bullet-patterns.yml";
+      return_if ( !std::filesystem::exists(path));
+      const Yaml config(path);
+    #else
+      return_if ( !hpw::archive->has_file("config/bullet-patterns.yml"));
+      Bytes buf;
+      const Yaml config(hpw::archive->get_view("config/bullet-patterns.yml", buf),
+        "config/bullet-patterns.yml");
+    #endif
+
+    for (cnauto pattern_name: config.root_tags()) {
+      // паттерн может ссылаться на другие, поэтому id берётся после загрузки
+      auto pattern = load_bullet_pattern(config[pattern_name]);
+      patterns.at(find_pattern(pattern_name)) = std::move(pattern);
+    }
+  } // load_patterns
+
+  inline Entity* load_unknown_entity(Entity* master, const Entity_proto proto, const Vec pos) {
     // попытаться загрузить отсутствующий объект
+    cauto name = proto_names.at(proto); // копия, загрузчик может добавить прототипов
     auto config = load_entity_config();
     auto entity_node = config[name];
     auto type = entity_node.get_str("type", "error type");
-    entity_loaders[name] = make_entity_loader(type, entity_node);
-        
-    try {
-      return ( *entity_loaders.at(name) )(master, pos);
-    } catch (CN<std::out_of_range> ex) {
-      error("нет инициализатора для \"" << name << "\"");
-    }
-    return {};
+    auto loader = make_entity_loader(type, entity_node);
+    entity_loaders.at(proto) = loader;
+    iferror( !loader, "нет инициализатора для \"" << name << "\"");
+    return (*loader)(master, pos);
   }
 
   inline Entity* make(Entity* master, CN<Str> name, const Vec pos) {
-    #ifdef ECOMEM
-      return load_unknown_entity(master, name, pos);
+    #ifndef ECOMEM
+      iferror( !types_registered, "вызови register_types для заполнения entity_loaders");
     #endif
+    return make(master, find_proto(name), pos);
+  }
 
-    iferror(entity_loaders.empty(), "вызови register_types для заполнения entity_loaders");
+  inline Entity* make(Entity* master, const Entity_proto proto, const Vec pos) {
+    assert(proto < entity_loaders.size());
 
-    try {
-      auto entity_loader = entity_loaders.at(name);
-      assert(entity_loader);
-      return (*entity_loader)(master, pos);
-    } catch (CN<std::out_of_range> ex) {
-      #ifdef ECOMEM
-        return load_unknown_entity(master, name, pos);
-      #else
-        error("нет инициализатора для \"" << name << "\"");
-      #endif
-    }
-    return {};
+    #ifdef ECOMEM
+      auto ret = load_unknown_entity(master, proto, pos);
+    #else
+      cnauto entity_loader = entity_loaders[proto];
+      iferror( !entity_loader, "нет инициализатора для \"" << proto_names[proto] << "\"");
+      auto ret = (*entity_loader)(master, pos);
+    #endif
+    if (ret)
+      ret->proto = proto;
+    return ret;
   } // make
 
   inline Yaml load_entity_config() const {
     #ifdef EDITOR
       return Yaml(hpw::cur_dir + "config/entities.yml");
     #else
-      return Yaml(hpw::archive->get_file("config/entities.yml"));
+      Bytes buf;
+      return Yaml(hpw::archive->get_view("config/entities.yml", buf), "config/entities.yml");
     #endif
   }
 
@@ -263,6 +355,7 @@ struct Entity_mgr::Impl {
           entity_pos.y <= -bound ||
           entity_pos.y >= graphic::height + bound
         ) {
+          on_kill(entity.get());
           entity->status.live = false;
           entity->status.killed = true;
           entity->accept_kill_callbacks();
@@ -273,10 +366,14 @@ struct Entity_mgr::Impl {
 
   // возвращает первый попавшийся мёртвый объект нужного типа
   inline Entity* find_avaliable_entity(const Entity_type type) {
-    for (nauto entity: get_entities())
-      if (entity->type == type && !entity->status.live)
-        return entity.get();
-    return {};
+    auto it = free_entities.find(type);
+    return_if (it == free_entities.end(), {});
+    nauto list = it->second;
+    return_if (list.empty(), {});
+    auto ret = list.back();
+    list.pop_back();
+    assert( !ret->status.live);
+    return ret;
   }
 
   inline Player* get_player() const { return m_player; }
@@ -298,7 +395,13 @@ void Entity_mgr::update(const double dt) { impl->update(dt); }
 void Entity_mgr::clear() { impl->clear(); }
 void Entity_mgr::set_collider(CN<Shared<Collider>> new_collider) { impl->set_collider(new_collider); }
 void Entity_mgr::register_types() { impl->register_types(); }
+Pattern_id Entity_mgr::find_pattern(CN<Str> name) { return impl->find_pattern(name); }
+CN<Bullet_pattern> Entity_mgr::get_pattern(const Pattern_id pattern) const { return impl->patterns.at(pattern); }
+void Entity_mgr::set_pattern(const Pattern_id pattern, Bullet_pattern&& src) { impl->patterns.at(pattern) = std::move(src); }
 Entity* Entity_mgr::make(Entity* master, CN<Str> name, const Vec pos) { return impl->make(master, name, pos); }
+Entity* Entity_mgr::make(Entity* master, const Entity_proto proto, const Vec pos) { return impl->make(master, proto, pos); }
+Entity_proto Entity_mgr::find_proto(CN<Str> name) { return impl->find_proto(name); }
+CN<Str> Entity_mgr::get_proto_name(const Entity_proto proto) const { return impl->proto_names.at(proto); }
 Entity* Entity_mgr::registrate(Entitys::value_type&& entity) { return impl->registrate(std::move(entity)); }
 void Entity_mgr::add_scatter(CN<Scatter> scatter) { return impl->add_scatter(scatter); }
 void Entity_mgr::debug_draw(Image& dst) const { impl->debug_draw(dst); }
@@ -307,6 +410,7 @@ Mem_pool& Entity_mgr::get_hitbox_pool() { return impl->get_hitbox_pool(); }
 Mem_pool& Entity_mgr::get_entity_pool() { return impl->get_entity_pool(); }
 CN<Entitys> Entity_mgr::get_entities() const { return impl->get_entities(); }
 Entity* Entity_mgr::find_avaliable_entity(const Entity_type type) { return impl->find_avaliable_entity(type); }
+void Entity_mgr::on_kill(Entity* entity) { impl->on_kill(entity); }
 Player* Entity_mgr::get_player() const { return impl->get_player(); }
 void Entity_mgr::set_player(Player* player) { impl->set_player(player); }
 Vec Entity_mgr::target_for_enemy() const { return impl->target_for_enemy(); }
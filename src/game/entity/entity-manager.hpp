@@ -7,6 +7,7 @@
 #include "util/mempool.hpp"
 #include "game/entity/entity-type.hpp"
 #include "game/entity/entity.hpp"
+#include "game/entity/util/bullet-pattern.hpp"
 
 class Collider;
 class Entity;
@@ -47,8 +48,24 @@ public:
   @param pos соспавнить объект на этой позиции
   @return по возможности верёт объект, для последующего изменения извне */
   Entity* make(Entity* master, CN<Str> name, const Vec pos);
+  /// то же самое, но без поиска по имени. Прототип брать из find_proto
+  Entity* make(Entity* master, const Entity_proto proto, const Vec pos);
+  /** получить id прототипа объекта по его имени. Вызывать при загрузке,
+  id не меняется до пересоздания Entity_mgr */
+  Entity_proto find_proto(CN<Str> name);
+  /// имя прототипа, в отличие от id не зависит от порядка загрузки
+  CN<Str> get_proto_name(const Entity_proto proto) const;
+  /** получить id паттерна пуль по имени. Паттерны грузятся из
+  config/bullet-patterns.yml в register_types, id не меняется до пересоздания Entity_mgr */
+  Pattern_id find_pattern(CN<Str> name);
+  /// пустой паттерн, если его нет в конфиге и он не задан через set_pattern
+  CN<Bullet_pattern> get_pattern(const Pattern_id pattern) const;
+  /// задать паттерн из кода. Вызывать при загрузке
+  void set_pattern(const Pattern_id pattern, Bullet_pattern&& src);
   /// создать волну от взрыва расталкивающую объекты
   void add_scatter(CN<Scatter> scatter);
+  /// объект умер, в конце кадра его слот можно переиспользовать
+  void on_kill(Entity* entity);
   Mem_pool& get_phys_pool();
   Mem_pool& get_hitbox_pool();
   Mem_pool& get_entity_pool();
@@ -75,9 +92,5 @@ template <class T> inline T* Entity_mgr::allocate() {
 
   // если не нашли, то выделить новую память и зарегистрировать объект
   auto allocated = get_entity_pool().new_object<T>();
-  #ifdef ECOMEM
   return ptr2ptr<T*>(registrate(std::move(allocated)) );
-  #else
-  return ptr2ptr<T*>(registrate(std::move(allocated.get())) );
-  #endif
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include <typeinfo>
+#include <limits>
+#include <cstdint>
 #include "util/vector-types.hpp"
 #include "util/mempool.hpp"
 #include "util/math/num-types.hpp"
@@ -11,5 +13,10 @@ using Entitys = Vector<Pool_ptr(Entity)>;
 
 using hp_t = i64_t; /// for hp/dmg/mana
 
+/// id прототипа объекта из базы Entity_mgr (см. Entity_mgr::find_proto)
+using Entity_proto = std::uint32_t;
+/// прототип не задан
+constexpr Entity_proto ENTITY_PROTO_NONE {std::numeric_limits<Entity_proto>::max()};
+
 #define ENTITY_TYPE(T) typeid(T).hash_code()
 #define GET_SELF_TYPE ENTITY_TYPE(decltype(*this))
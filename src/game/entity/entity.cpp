@@ -10,6 +10,7 @@
 #include "game/core/fonts.hpp"
 #include "game/core/canvas.hpp"
 #include "game/core/debug.hpp"
+#include "game/core/entities.hpp"
 #include "game/core/graphic.hpp"
 #include "game/core/core.hpp"
 #include "game/entity/entity-manager.hpp"
@@ -24,21 +25,27 @@ Entity::Entity()
 , light {}
 , master {}
 , uid (get_entity_uid())
+, rnd (make_rnd_stream(uid | (uint64_t(hpw::game_updates_safe) << 16)))
 , status {}
 , type {GET_SELF_TYPE}
+, proto {ENTITY_PROTO_NONE}
 { status.live = true; }
 
 Entity::Entity(Entity_type new_type): Entity() { type = new_type; }
 
 void Entity::kill() {
+  if (status.live && hpw::entity_mgr)
+    hpw::entity_mgr->on_kill(this);
   status.live = false;
   status.killed = true;
   accept_kill_callbacks();
 }
 
 void Entity::accept_kill_callbacks() {
-  for (cnauto callback: kill_callbacks)
+  for (cnauto callback: kill_callbacks) {
+    break_if ( !callback);
     callback(*this);
+  }
 }
 
 void Entity::draw(Image& dst, const Vec offset) const {
@@ -64,12 +71,14 @@ void Entity::draw(Image& dst, const Vec offset) const {
 } // draw
 
 void Entity::update(double dt) {
-  move_it(dt);
+  // phys к этому моменту уже сдвинут в Entity_mgr через Phys::update_planned
   anim_ctx.update(dt, *this);
 
   // применить внешние колбэки
-  for (cnauto callback: update_callbacks)
+  for (cnauto callback: update_callbacks) {
+    break_if ( !callback);
     callback(*this, dt);
+  }
 
   if (heat_distort && !status.disable_heat_distort)
     heat_distort->update(dt);
@@ -82,10 +91,6 @@ void Entity::set_master(Master_p new_master) {
   master = new_master;
 }
 
-void Entity::move_it(double dt) {
-  phys.update(dt);
-}
-
 void Entity::set_pos(const Vec pos) {
   phys.set_pos(pos);
 }
@@ -124,17 +129,28 @@ void Entity::debug_draw(Image& dst, const Vec offset) const {
   }
 }
 
-void Entity::move_update_callback(Update_callback&& callback) {
-  if (callback)
-    update_callbacks.emplace_back(std::move(callback));
+/// положить колбэк в первую свободную ячейку
+template <class Callbacks, class Callback>
+inline void add_callback(Callbacks& dst, Callback&& callback) {
+  return_if( !callback);
+  for (nauto slot: dst) {
+    if ( !slot) {
+      slot = std::move(callback);
+      return;
+    }
+  }
+  error("у объекта нет места под ещё один колбэк (максимум " << dst.size() << ")");
 }
 
-void Entity::move_kill_callback(Kill_callback&& callback) {
-  if (callback)
-    kill_callbacks.emplace_back(std::move(callback));
-}
+void Entity::move_update_callback(Update_callback&& callback)
+  { add_callback(update_callbacks, std::move(callback)); }
+
+void Entity::move_kill_callback(Kill_callback&& callback)
+  { add_callback(kill_callbacks, std::move(callback)); }
 
 void Entity::clear_callbacks() {
-  update_callbacks.clear();
-  kill_callbacks.clear();
+  for (nauto callback: update_callbacks)
+    callback = {};
+  for (nauto callback: kill_callbacks)
+    callback = {};
 }
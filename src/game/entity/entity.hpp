@@ -1,11 +1,13 @@
 #pragma once
-#include <functional>
+#include <array>
 #include "status.hpp"
 #include "entity-type.hpp"
 #include "util/macro.hpp"
 #include "util/math/num-types.hpp"
+#include "util/math/random.hpp"
 #include "util/mem-types.hpp"
 #include "util/mempool.hpp"
+#include "util/inline-func.hpp"
 #include "game/entity/util/phys.hpp"
 #include "game/entity/util/anim-ctx.hpp"
 
@@ -20,14 +22,29 @@ struct Vec;
 class Entity {
   nocopy(Entity);
 
+public:
+  /** сколько байт захвата влезает в колбэк без выделения памяти.
+  Самый большой колбэк апдейта - Rotate_speed_addiction (40 байт),
+  колбэки смерти захватывают только указатель. Больший функтор
+  не скомпилируется в move_update_callback/move_kill_callback */
+  constx std::size_t UPDATE_CALLBACK_SZ = 40;
+  constx std::size_t KILL_CALLBACK_SZ = 16;
+  /** сколько колбэков можно повесить на объект. Больше всех берут
+  вращающиеся объекты в level-debug-3 (3 апдейта) и враги
+  level-tutorial (1 апдейт + 1 смерть). Лишний колбэк - error в рантайме */
+  constx std::size_t UPDATE_CALLBACK_SLOTS = 3;
+  constx std::size_t KILL_CALLBACK_SLOTS = 2;
   /// <self ptr, dt>
-  using Update_callback = std::function<void (Entity&, double)>;
+  using Update_callback = Inline_func<void (Entity&, double), UPDATE_CALLBACK_SZ>;
   /// <self ptr>
-  using Kill_callback = std::function<void (Entity&)>;
-  Vector<Update_callback> update_callbacks {}; /// внешние колбэки на обработку апдейта
-  Vector<Kill_callback> kill_callbacks {}; /// внешние колбэки на обработку смерти
+  using Kill_callback = Inline_func<void (Entity&), KILL_CALLBACK_SZ>;
+
+private:
+  /** колбэки хранятся прямо в объекте, поэтому спавн и переиспользование
+  объекта не трогают кучу. Заняты первые ячейки, после первой пустой - ничего */
+  std::array<Update_callback, UPDATE_CALLBACK_SLOTS> update_callbacks {}; /// внешние колбэки на обработку апдейта
+  std::array<Kill_callback, KILL_CALLBACK_SLOTS> kill_callbacks {}; /// внешние колбэки на обработку смерти
 
-  void move_it(double dt);
   void draw_pos(Image& dst, const Vec offset) const;
   void debug_draw(Image& dst, const Vec offset) const;
 
@@ -39,8 +56,13 @@ public:
   using Master_p = CP<Entity>;
   Master_p master {}; /// объект создатель
   Uid uid {};
+  /** свой поток рандома, задаётся сидом, uid и апдейтом спавна. Не зависит от порядка апдейта
+  других объектов, поэтому годится для параллельного кода и реплеев */
+  Rnd_stream rnd {};
   mutable Enity_status status {}; /// флаги
   Entity_type type {GET_SELF_TYPE};
+  /// из какого прототипа сделан (Entity_mgr::make), ENTITY_PROTO_NONE - создан напрямую
+  Entity_proto proto {ENTITY_PROTO_NONE};
   
   Entity();
   explicit Entity(Entity_type new_type);
@@ -19,7 +19,7 @@
 #include "graphic/effect/light.hpp"
 
 struct Explosion_loader::Impl {
-  /* создаёт m_particle_count частиц из списка m_entity_names и раскидывает
+  /* создаёт m_particle_count частиц из списка m_entities и раскидывает
   их по сторонам. Дальность раздёла - m_particles_range */
   real m_power {}; // pps
   real m_range {};
@@ -27,7 +27,7 @@ struct Explosion_loader::Impl {
   int m_particle_count {};
   bool m_randomize_cur_frame {false};
   bool m_ignore_scatter {false};
-  Strs m_entity_names {};
+  Vector<Entity_proto> m_entities {};
   Heat_distort m_heat_distort {};
 
   inline explicit Impl(CN<Yaml> config) {
@@ -38,8 +38,10 @@ struct Explosion_loader::Impl {
     assert(m_particle_count > 0);
     m_randomize_cur_frame = config.get_bool("randomize_cur_frame");
     m_ignore_scatter = config.get_bool("ignore_scatter");
-    m_entity_names = config.get_v_str("names");
-    assert(!m_entity_names.empty());
+    cauto entity_names = config.get_v_str("names");
+    assert(!entity_names.empty());
+    for (cnauto name: entity_names)
+      m_entities.emplace_back( hpw::entity_mgr->find_proto(name) );
     if (auto heat_distort_node = config["heat_distort"]; heat_distort_node.check())
       m_heat_distort = load_heat_distort(heat_distort_node);
     // TODO load hitbox anim
@@ -57,8 +59,8 @@ struct Explosion_loader::Impl {
     // создать частицы
     cfor (particle_idx, m_particle_count) {
       // определить чё соспавнить
-      auto entity_name = m_entity_names.at(rndu() % m_entity_names.size());
-      auto it = hpw::entity_mgr->make(master, entity_name, pos);
+      auto proto = m_entities.at(rndu() % m_entities.size());
+      auto it = hpw::entity_mgr->make(master, proto, pos);
       // инит флагов
       it->status.ignore_self_type = true;
       it->status.ignore_master = true;
@@ -66,7 +68,7 @@ struct Explosion_loader::Impl {
       if (m_randomize_cur_frame)
         it->anim_ctx.randomize_cur_frame_safe();
       // разлёт в случайную сторону, но с сохранением начального направления
-      Vec motion = rand_normalized_stable() * rndr(0, pps(m_particles_range));
+      Vec motion = rand_normalized(it->rnd) * it->rnd.rndr(0, pps(m_particles_range));
       it->phys.set_vel(it->phys.get_vel() + motion);
       it->heat_distort = new_shared<Heat_distort>(m_heat_distort);
       // TODO создание вспышки
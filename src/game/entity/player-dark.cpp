@@ -23,24 +23,6 @@
 
 Player_dark::Player_dark(): Player() {}
 
-/// спавнит мелкие пульки в след за мощным выстрелом
-void spawn_small_bullets(Entity& master, double dt) {
-  // TODO all vals by config
-
-  // TODO by dt timer
-  if ((hpw::game_updates_safe % 5) == 0) {
-    auto it = hpw::entity_mgr->make(&master, "bullet.player.small",
-      master.phys.get_pos());
-    // замедлить эти пули
-    it->phys.set_speed(it->phys.get_speed() * rndr(0.5, 1));
-    // чтобы пули разлетались во все стороны
-    it->phys.set_deg(it->phys.get_deg() + rndr(-45, 45));
-    it->phys.set_force( 7.5_pps );
-    it->move_update_callback( Kill_by_timeout(rndr(0.1, 0.7)) );
-    it->status.layer_up = false;
-  } // if timer
-}
-
 void Player_dark::shoot(double dt) {
   // стрелять менее часто, при нехватке энергии
   if (energy <= m_energy_level_for_decrease_shoot_speed)
@@ -57,19 +39,7 @@ void Player_dark::shoot(double dt) {
 } // shoot
 
 void Player_dark::power_shoot(double dt) {
-  cfor (_, 30) { // TODO конфиг
-    cauto spawn_pos = phys.get_pos() + Vec(rndr(-7, 7), 0); // TODO конфиг
-    auto bullet = hpw::entity_mgr->make(this, "bullet.player.mid", spawn_pos);
-    // пуля смотрит вверх в шмап моде
-    bullet->phys.set_deg(270);
-    // передача импульса для шмап мода
-    bullet->phys.set_speed( pps(rndr(13, 17)) ); // TODO конфиг
-    bullet->phys.set_vel(bullet->phys.get_vel() + phys.get_vel());
-    // разброс
-    bullet->phys.set_deg(bullet->phys.get_deg() + rndr(-75, 75)); // TODO конфиг
-    bullet->move_update_callback(&spawn_small_bullets);
-    bullet->status.layer_up = true;
-  }
+  spawn_pattern(m_power_shoot_pattern, *this, dt);
 
   // отдача
   hpw::entity_mgr->add_scatter(Scatter {
@@ -80,23 +50,11 @@ void Player_dark::power_shoot(double dt) {
 } // power_shoot
 
 void Player_dark::default_shoot(double dt) {
-  cfor (_, m_shoot_timer.update(dt)) {
-    cfor (bullet_count, m_default_shoot_count) { // несколько за раз
-      cauto spawn_pos = phys.get_pos() + Vec(rndr(-7, 7), 0); // смещение пули при спавне
-      auto bullet = hpw::entity_mgr->make(this, "bullet.player.small", spawn_pos);
-      // пуля смотрит вверх в шмап моде
-      bullet->phys.set_deg(270);
-      bullet->phys.set_speed(m_shoot_speed);
-      // передача импульса
-      bullet->phys.set_vel(bullet->phys.get_vel() + phys.get_vel());
-      // разброс
-      auto deg_spread = is_pressed(hpw::keycode::focus)
-        ? m_deg_focused_shoot
-        : m_deg_spread_shoot;
-      deg_spread = rndr(-deg_spread * 0.5, deg_spread * 0.5);
-      bullet->phys.set_deg(bullet->phys.get_deg() + deg_spread);
-    }
-  } // for m_shoot_timer
+  cauto pattern = is_pressed(hpw::keycode::focus)
+    ? m_focused_shoot_pattern
+    : m_shoot_pattern;
+  cfor (_, m_shoot_timer.update(dt))
+    spawn_pattern(pattern, *this, dt);
 } // default_shoot
 
 void Player_dark::sub_en(hp_t val) { energy = std::max<hp_t>(0, energy - val); }
@@ -272,10 +230,75 @@ struct Player_dark::Loader::Impl {
   real m_deg_focused_shoot {};
   int m_default_shoot_count {};
   real m_shoot_speed {};
+  Pattern_id m_shoot_pattern {PATTERN_NONE};
+  Pattern_id m_focused_shoot_pattern {PATTERN_NONE};
+  Pattern_id m_power_shoot_pattern {PATTERN_NONE};
   real m_boost_up {};
   real m_boost_down {};
   real m_percent_level_for_blink {};
   real m_window_star_len {};
+  Entity_proto m_small_bullet {ENTITY_PROTO_NONE};
+  Entity_proto m_mid_bullet {ENTITY_PROTO_NONE};
+
+  /// обычный выстрел по старым полям конфига shoot
+  inline Bullet_pattern default_shoot_pattern(real deg_spread) const {
+    return Bullet_pattern { .volleys {
+      Bullet_volley {
+        .bullet = m_small_bullet,
+        .count = scast<std::uint32_t>(m_default_shoot_count),
+        .inherit_vel = true, // передача импульса
+        .deg = 270, // пуля смотрит вверх в шмап моде
+        .arc = deg_spread,
+        .spawn_rect {7, 0}, // смещение пули при спавне
+        .speed_min = pps(m_shoot_speed),
+        .speed_max = pps(m_shoot_speed),
+      }
+    } };
+  }
+
+  /// усиленный выстрел, каждая пуля пускает за собой мелкие пульки
+  inline Bullet_pattern power_shoot_pattern(Pattern_id spark) const {
+    return Bullet_pattern { .volleys {
+      Bullet_volley {
+        .bullet = m_mid_bullet,
+        .count = 30,
+        .child = spark,
+        .inherit_vel = true,
+        .layer_up = true,
+        .deg = 270,
+        .arc = 150,
+        .spawn_rect {7, 0},
+        .speed_min = pps(13),
+        .speed_max = pps(17),
+        .child_period = scast<real>(5 * hpw::target_update_time),
+      }
+    } };
+  }
+
+  /// мелкие пульки за мощным выстрелом: медленнее и разлетаются во все стороны
+  inline Bullet_pattern power_shoot_spark_pattern() const {
+    return Bullet_pattern { .volleys {
+      Bullet_volley {
+        .bullet = m_small_bullet,
+        .aim = Pattern_aim::master,
+        .speed_scale = true,
+        .arc = 90,
+        .speed_min = 0.5,
+        .speed_max = 1,
+        .force = 7.5_pps,
+        .lifetime_min = 0.1,
+        .lifetime_max = 0.7,
+      }
+    } };
+  }
+
+  /// взять паттерн из config/bullet-patterns.yml, а если его там нет - задать свой
+  inline static Pattern_id init_pattern(CN<Str> name, auto&& make_default) {
+    cauto ret = hpw::entity_mgr->find_pattern(name);
+    if (hpw::entity_mgr->get_pattern(ret).empty())
+      hpw::entity_mgr->set_pattern(ret, make_default());
+    return ret;
+  }
 
   inline explicit Impl(CN<Yaml> config) {
     m_collidable_info.load(config);
@@ -308,6 +331,16 @@ struct Player_dark::Loader::Impl {
     m_deg_spread_shoot = shoot_node.get_real("deg_spread_shoot");
     m_deg_focused_shoot = shoot_node.get_real("deg_focused_shoot");
     m_shoot_speed = shoot_node.get_real("shoot_speed");
+    m_small_bullet = hpw::entity_mgr->find_proto("bullet.player.small");
+    m_mid_bullet = hpw::entity_mgr->find_proto("bullet.player.mid");
+    m_shoot_pattern = init_pattern("player.dark.shoot",
+      [&]{ return default_shoot_pattern(m_deg_spread_shoot); });
+    m_focused_shoot_pattern = init_pattern("player.dark.shoot.focused",
+      [&]{ return default_shoot_pattern(m_deg_focused_shoot); });
+    cauto spark = init_pattern("player.dark.power_shoot.spark",
+      [&]{ return power_shoot_spark_pattern(); });
+    m_power_shoot_pattern = init_pattern("player.dark.power_shoot",
+      [&]{ return power_shoot_pattern(spark); });
 
     // проверка параметров
     assert(m_window_star_len > 0);
@@ -353,14 +386,13 @@ struct Player_dark::Loader::Impl {
     it.m_power_shoot_price = it.energy_max * (m_percent_for_power_shoot_price / 100.0);
     it.m_energy_level_for_decrease_shoot_speed = it.energy_max * (m_percent_for_decrease_shoot_speed / 100.0);
     it.m_decrease_shoot_speed_ratio = m_decrease_shoot_speed_ratio;
-    it.m_default_shoot_count = m_default_shoot_count;
-    it.m_deg_spread_shoot = m_deg_spread_shoot;
-    it.m_deg_focused_shoot = m_deg_focused_shoot;
-    it.m_shoot_speed = pps(m_shoot_speed);
     it.m_boost_up = m_boost_up;
     it.m_boost_down = m_boost_down;
     it.m_level_for_blink = it.energy_max * (m_percent_level_for_blink / 100.0);
     it.m_window_star_len = m_window_star_len;
+    it.m_shoot_pattern = m_shoot_pattern;
+    it.m_focused_shoot_pattern = m_focused_shoot_pattern;
+    it.m_power_shoot_pattern = m_power_shoot_pattern;
 
     return entity;
   } // op ()
@@ -3,6 +3,7 @@
 #include "entity-loader.hpp"
 #include "util/mem-types.hpp"
 #include "util/math/timer.hpp"
+#include "game/entity/util/bullet-pattern.hpp"
 
 class Yaml;
 class Anim;
@@ -33,14 +34,13 @@ public:
   hp_t m_energy_for_power_shoot {}; /// сколько должно быть энергии для мощного выстрела
   hp_t m_energy_level_for_decrease_shoot_speed {}; /// если энергия ниже этого урвоня, то замедлить стрельбу
   real m_decrease_shoot_speed_ratio {}; /// на сколько замедлить скорость стрельбы при нехватке энергии
-  uint m_default_shoot_count {}; /// сколько за раз выпустить пуль при обычной атаке
-  real m_deg_spread_shoot {}; /// угол разброса при обычном выстреле
-  real m_deg_focused_shoot {}; /// угол разброса при фокусировке
-  real m_shoot_speed {}; /// скорость обычных выстрелов
   real m_boost_up {}; /// ускорение вперёд
   real m_boost_down {}; /// ускорение назад
   real m_level_for_blink {}; /// уровень энергии, при котором игрок мигает ярче
   real m_window_star_len {}; /// размер звёздочек на окошках бумера
+  Pattern_id m_shoot_pattern {PATTERN_NONE}; /// обычный выстрел
+  Pattern_id m_focused_shoot_pattern {PATTERN_NONE}; /// обычный выстрел при фокусировке
+  Pattern_id m_power_shoot_pattern {PATTERN_NONE}; /// усиленный выстрел
 
   Player_dark();
   ~Player_dark() = default;
@@ -0,0 +1,258 @@
+#include <cassert>
+#include "bullet-pattern.hpp"
+#include "entity-util.hpp"
+#include "phys.hpp"
+#include "util/error.hpp"
+#include "util/hpw-util.hpp"
+#include "util/file/yaml.hpp"
+#include "util/math/random.hpp"
+#include "util/math/vec-util.hpp"
+#include "game/core/entities.hpp"
+#include "game/entity/entity.hpp"
+#include "game/entity/player.hpp"
+#include "game/entity/entity-manager.hpp"
+
+inline Pattern_aim load_aim(CN<Str> name) {
+  if (name.empty() || name == "fixed") return Pattern_aim::fixed;
+  if (name == "master") return Pattern_aim::master;
+  if (name == "target") return Pattern_aim::target;
+  if (name == "predict") return Pattern_aim::predict;
+  if (name == "target_or_predict") return Pattern_aim::target_or_predict;
+  error("неизвестный тип прицеливания \"" << name << "\"");
+  return {};
+}
+
+inline Pattern_shape load_shape(CN<Str> name) {
+  if (name.empty() || name == "spread") return Pattern_shape::spread;
+  if (name == "fan") return Pattern_shape::fan;
+  if (name == "ring") return Pattern_shape::ring;
+  error("неизвестная форма залпа \"" << name << "\"");
+  return {};
+}
+
+/// прочитать [min, max] или [val] в min и max
+inline void load_minmax(CN<Yaml> node, CN<Str> name, real& min, real& max) {
+  cauto vals = node.get_v_real(name);
+  return_if (vals.empty());
+  min = vals.at(0);
+  max = vals.size() > 1 ? vals[1] : min;
+  assert(min <= max);
+}
+
+inline Vec load_vec(CN<Yaml> node, CN<Str> name) {
+  cauto vals = node.get_v_real(name);
+  return_if (vals.size() < 2, {});
+  return Vec(vals[0], vals[1]);
+}
+
+/// флаг, которого нет в конфиге, остаётся незаданным
+inline std::optional<bool> load_opt_bool(CN<Yaml> node, CN<Str> name) {
+  return_if (node.get_str(name).empty(), {});
+  return node.get_bool(name);
+}
+
+inline Bullet_volley load_volley(CN<Yaml> node) {
+  Bullet_volley ret;
+  cauto bullet_name = node.get_str("bullet");
+  iferror(bullet_name.empty(), "у залпа не задан bullet");
+  ret.bullet = hpw::entity_mgr->find_proto(bullet_name);
+  ret.count = node.get_int("count", 1);
+  ret.aim = load_aim(node.get_str("aim"));
+  ret.shape = load_shape(node.get_str("shape"));
+  ret.inherit_vel = node.get_bool("inherit_vel");
+  ret.ignore_scatter = load_opt_bool(node, "ignore_scatter");
+  ret.layer_up = load_opt_bool(node, "layer_up");
+  ret.speed_scale = node.get_bool("speed_scale");
+  ret.delay = node.get_real("delay");
+  ret.deg = node.get_real("deg");
+  ret.arc = node.get_real("arc");
+  ret.offset = load_vec(node, "offset");
+  ret.spawn_rect = load_vec(node, "spawn_rect");
+  ret.spawn_range = node.get_real("spawn_range");
+  load_minmax(node, "speed", ret.speed_min, ret.speed_max);
+  if ( !ret.speed_scale) {
+    ret.speed_min = pps(ret.speed_min);
+    ret.speed_max = pps(ret.speed_max);
+  }
+  ret.predict_speed = pps( node.get_real("predict_speed") );
+  ret.accel = pps( node.get_real("accel") );
+  ret.force = pps( node.get_real("force") );
+  load_minmax(node, "lifetime", ret.lifetime_min, ret.lifetime_max);
+  if (cauto child_name = node.get_str("child"); !child_name.empty()) {
+    ret.child = hpw::entity_mgr->find_pattern(child_name);
+    ret.child_period = node.get_real("child_period");
+    iferror(ret.child_period <= 0, "у залпа с child не задан child_period");
+  }
+
+  assert(ret.count > 0);
+  assert(ret.delay >= 0);
+  assert(ret.arc >= 0);
+  assert(ret.spawn_range >= 0);
+  assert(ret.lifetime_min >= 0);
+  return ret;
+} // load_volley
+
+Bullet_pattern load_bullet_pattern(CN<Yaml> node) {
+  Bullet_pattern ret;
+  for (cnauto volley_name: node.root_tags())
+    ret.volleys.emplace_back( load_volley(node[volley_name]) );
+  return ret;
+}
+
+/// направление залпа без поправки на форму
+inline real volley_deg(CN<Bullet_volley> volley, Entity& bullet, Rnd_stream& rnd, double dt) {
+  switch (volley.aim) {
+    default:
+    case Pattern_aim::fixed: return volley.deg;
+    case Pattern_aim::master: return bullet.phys.get_deg() + volley.deg;
+    case Pattern_aim::target:
+    case Pattern_aim::predict:
+    case Pattern_aim::target_or_predict: {
+      cauto player = hpw::entity_mgr->get_player();
+      cauto use_predict = player && (volley.aim == Pattern_aim::predict ||
+        (volley.aim == Pattern_aim::target_or_predict && (rnd.rndb() & 1)));
+      if (use_predict)
+        return deg_to_target(bullet, predict(bullet, *player, dt)) + volley.deg;
+      return deg_to_target(bullet, hpw::entity_mgr->target_for_enemy()) + volley.deg;
+    }
+  }
+} // volley_deg
+
+/// поправка угла для пули номер idx в залпе
+inline real shape_deg(CN<Bullet_volley> volley, std::uint32_t idx, Rnd_stream& rnd) {
+  switch (volley.shape) {
+    default:
+    case Pattern_shape::spread:
+      return volley.arc > 0 ? rnd.rndr(-volley.arc * 0.5, volley.arc * 0.5) : 0;
+    case Pattern_shape::fan:
+      return_if (volley.count < 2, 0);
+      return -volley.arc * 0.5 + volley.arc * idx / (volley.count - 1);
+    case Pattern_shape::ring:
+      return 360.0 * idx / volley.count;
+  }
+}
+
+void spawn_volley(CN<Bullet_volley> volley, Entity& master, double dt) {
+  assert(volley.bullet != ENTITY_PROTO_NONE);
+  cauto has_speed = volley.speed_max > 0;
+  cauto need_aim_speed = volley.aim == Pattern_aim::target ||
+    volley.aim == Pattern_aim::predict || volley.aim == Pattern_aim::target_or_predict;
+  cauto master_pos = master.phys.get_pos() + volley.offset;
+  // рандом из потока стрелявшего, чтобы залп не зависел от других объектов
+  nauto rnd = master.rnd;
+
+  cfor (idx, volley.count) {
+    // случайности берутся всегда в одном порядке: позиция, скорость, угол, время жизни
+    auto pos = master_pos;
+    if (volley.spawn_rect.x != 0)
+      pos.x += rnd.rndr(-volley.spawn_rect.x, volley.spawn_rect.x);
+    if (volley.spawn_rect.y != 0)
+      pos.y += rnd.rndr(-volley.spawn_rect.y, volley.spawn_rect.y);
+    if (volley.spawn_range > 0)
+      pos += rand_normalized(rnd) * volley.spawn_range;
+    auto bullet = hpw::entity_mgr->make(&master, volley.bullet, pos);
+    assert(bullet);
+    nauto phys = bullet->phys;
+
+    real speed = phys.get_speed();
+    if (has_speed) {
+      speed = volley.speed_min == volley.speed_max
+        ? volley.speed_min
+        : rnd.rndr(volley.speed_min, volley.speed_max);
+      if (volley.speed_scale)
+        speed *= phys.get_speed();
+    }
+    // упреждение считается по скорости пули
+    if (need_aim_speed)
+      phys.set_speed(volley.predict_speed > 0 ? volley.predict_speed : speed);
+    phys.set_deg( volley_deg(volley, *bullet, rnd, dt) );
+    phys.set_speed(speed);
+    if (volley.inherit_vel)
+      phys.set_vel(phys.get_vel() + master.phys.get_vel());
+    if (cauto deg = shape_deg(volley, idx, rnd); deg != 0)
+      phys.set_deg(phys.get_deg() + deg);
+
+    if (volley.accel > 0)
+      phys.set_accel(volley.accel);
+    if (volley.force > 0)
+      phys.set_force(volley.force);
+    if (volley.ignore_scatter)
+      bullet->status.ignore_scatter = *volley.ignore_scatter;
+    if (volley.layer_up)
+      bullet->status.layer_up = *volley.layer_up;
+
+    cauto lifetime = volley.lifetime_min == volley.lifetime_max
+      ? volley.lifetime_min
+      : rnd.rndr(volley.lifetime_min, volley.lifetime_max);
+    if (lifetime > 0 || volley.child != PATTERN_NONE)
+      bullet->move_update_callback( Pattern_bullet_update(volley.child,
+        volley.child_period, lifetime) );
+  } // for count
+} // spawn_volley
+
+/** залп по индексу. Копия, потому что make может подгрузить
+загрузчик (ECOMEM), а тот - добавить паттернов в базу */
+inline Bullet_volley get_volley(Pattern_id pattern, std::size_t idx)
+  { return hpw::entity_mgr->get_pattern(pattern).volleys.at(idx); }
+
+inline std::size_t volley_count(Pattern_id pattern)
+  { return hpw::entity_mgr->get_pattern(pattern).volleys.size(); }
+
+void spawn_pattern(Pattern_id pattern, Entity& master, double dt) {
+  cfor (idx, volley_count(pattern))
+    spawn_volley(get_volley(pattern, idx), master, dt);
+}
+
+/// выпустить залпы, которые уже дождались своей паузы
+inline void fire_ready(Pattern_id& pattern, std::uint32_t& next, real& wait,
+Entity& master, double dt) {
+  while (next < volley_count(pattern) && wait <= 0) {
+    spawn_volley(get_volley(pattern, next), master, dt);
+    ++next;
+    if (next < volley_count(pattern))
+      wait += get_volley(pattern, next).delay;
+  }
+  if (next >= volley_count(pattern))
+    pattern = PATTERN_NONE;
+}
+
+void Pattern_runner::start(Pattern_id pattern, Entity& master, double dt) {
+  return_if (volley_count(pattern) == 0);
+  m_pattern = pattern;
+  m_next = 0;
+  m_wait = get_volley(pattern, 0).delay;
+  fire_ready(m_pattern, m_next, m_wait, master, dt);
+}
+
+void Pattern_runner::update(Entity& master, double dt) {
+  return_if ( !active());
+  m_wait -= dt;
+  fire_ready(m_pattern, m_next, m_wait, master, dt);
+}
+
+Pattern_bullet_update::Pattern_bullet_update(Pattern_id child,
+real child_period, real lifetime)
+: m_child {child}
+, m_child_period (child_period)
+, m_lifetime (lifetime)
+{
+  assert(child == PATTERN_NONE || child_period > 0);
+  assert(lifetime >= 0);
+}
+
+void Pattern_bullet_update::operator()(Entity& entity, double dt) {
+  if (m_lifetime > 0) {
+    m_lifetime -= dt;
+    if (m_lifetime <= 0) {
+      entity.kill();
+      return;
+    }
+  }
+
+  return_if (m_child == PATTERN_NONE);
+  m_child_timer -= dt;
+  while (m_child_timer <= 0) {
+    m_child_timer += m_child_period;
+    spawn_pattern(m_child, entity, dt);
+  }
+} // op ()
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include "util/macro.hpp"
+#include "util/vector-types.hpp"
+#include "util/math/num-types.hpp"
+#include "util/math/vec.hpp"
+#include "game/entity/entity-type.hpp"
+
+class Yaml;
+class Entity;
+
+/// id паттерна пуль из базы Entity_mgr (см. Entity_mgr::find_pattern)
+using Pattern_id = std::uint32_t;
+/// паттерн не задан
+constexpr Pattern_id PATTERN_NONE {std::numeric_limits<Pattern_id>::max()};
+
+/// куда направлен залп
+enum class Pattern_aim: std::uint8_t {
+  fixed = 0, /// на угол deg
+  master, /// как пулю направил загрузчик (по движению стрелявшего) + deg
+  target, /// в target_for_enemy + deg
+  predict, /// на упреждение движения игрока + deg
+  target_or_predict, /// случайно target или predict
+};
+
+/// как пули залпа расходятся от направления залпа
+enum class Pattern_shape: std::uint8_t {
+  spread = 0, /// случайно в пределах arc
+  fan, /// равномерно в пределах arc
+  ring, /// равномерно по кругу
+};
+
+/// залп из count одинаковых пуль. Только данные, без колбэков
+struct Bullet_volley {
+  Entity_proto bullet {ENTITY_PROTO_NONE};
+  std::uint32_t count {1}; /// сколько пуль за залп
+  Pattern_id child {PATTERN_NONE}; /// паттерн, который пуля пускает сама
+  Pattern_aim aim {};
+  Pattern_shape shape {};
+  bool inherit_vel {}; /// добавить пуле скорость стрелявшего
+  std::optional<bool> ignore_scatter {}; /// не задано - как у прототипа пули
+  std::optional<bool> layer_up {}; /// не задано - как у прототипа пули
+  bool speed_scale {}; /// speed_min/max умножают скорость пули, а не задают её
+  real delay {}; /// пауза перед залпом (сек)
+  real deg {}; /// угол залпа или поправка к нему
+  real arc {}; /// ширина веера (градусы)
+  Vec offset {}; /// смещение точки спавна от стрелявшего
+  Vec spawn_rect {}; /// случайный разброс точки спавна на ±x, ±y
+  real spawn_range {}; /// случайный разброс точки спавна по кругу
+  real speed_min {}; /// скорость пули (pps), 0 - оставить как есть
+  real speed_max {};
+  real predict_speed {}; /// с этой скоростью считается упреждение, 0 - по speed
+  real accel {}; /// 0 - не менять
+  real force {}; /// 0 - не менять
+  real lifetime_min {}; /// время жизни пули (сек), 0 - не ограничено
+  real lifetime_max {};
+  real child_period {}; /// как часто пуля пускает child (сек)
+}; // Bullet_volley
+
+/// последовательность залпов
+struct Bullet_pattern {
+  Vector<Bullet_volley> volleys {};
+  inline bool empty() const { return volleys.empty(); }
+};
+
+/** прочитать паттерн из конфига.
+Каждая ветвь node - залп, залпы идут в порядке ветвей */
+Bullet_pattern load_bullet_pattern(CN<Yaml> node);
+/// выпустить один залп от master
+void spawn_volley(CN<Bullet_volley> volley, Entity& master, double dt);
+/// выпустить все залпы паттерна сразу, без пауз
+void spawn_pattern(Pattern_id pattern, Entity& master, double dt);
+
+/** проигрывает паттерн с паузами между залпами.
+Хранится в стреляющем объекте и обновляется каждый апдейт */
+class Pattern_runner final {
+  Pattern_id m_pattern {PATTERN_NONE};
+  std::uint32_t m_next {}; /// индекс следующего залпа
+  real m_wait {}; /// сколько ещё ждать до m_next
+
+public:
+  /// начать паттерн с начала. Залпы без пауз выходят сразу
+  void start(Pattern_id pattern, Entity& master, double dt);
+  /// выпустить залпы, у которых вышла пауза
+  void update(Entity& master, double dt);
+  inline bool active() const { return m_pattern != PATTERN_NONE; }
+}; // Pattern_runner
+
+/** пуля из паттерна: ограничивает время жизни и пускает дочерний паттерн.
+Данные вместо захвата, чтобы колбэк не выделял память */
+class Pattern_bullet_update final {
+  Pattern_id m_child {PATTERN_NONE};
+  real m_child_period {};
+  real m_child_timer {};
+  real m_lifetime {}; /// 0 - не ограничено
+
+public:
+  Pattern_bullet_update(Pattern_id child, real child_period, real lifetime);
+  void operator()(Entity& entity, double dt);
+};
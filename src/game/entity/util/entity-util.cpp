@@ -15,6 +15,12 @@
 #include "util/math/mat.hpp"
 #include "util/math/vec-util.hpp"
 
+// колбэки отсюда должны влезать в ячейки Entity без выделения памяти
+static_assert(Entity::Update_callback::fits<Kill_by_timeout>);
+static_assert(Entity::Update_callback::fits<Anim_speed_slowdown>);
+static_assert(Entity::Update_callback::fits<Anim_speed_addiction>);
+static_assert(Entity::Update_callback::fits<Rotate_speed_addiction>);
+
 static Uid m_entity_uid = 0;
 
 void add_anim(Entity& dst, CN<Str> anim_name) {
@@ -1,13 +1,16 @@
 #include <cassert>
 #include "collidable-info.hpp"
+#include "game/core/entities.hpp"
 #include "game/entity/collidable.hpp"
+#include "game/entity/entity-manager.hpp"
 #include "game/entity/util/entity-util.hpp"
 #include "util/file/yaml.hpp"
 
 void Collidable_info::load(CN<Yaml> node) {
   hp = node.get_int("hp");
   dmg = node.get_int("dmg");
-  exolosion_name = node.get_str("explosion");
+  if (cauto explosion_name = node.get_str("explosion"); !explosion_name.empty())
+    explosion = hpw::entity_mgr->find_proto(explosion_name);
   ignore_enemy = node.get_bool("ignore_enemy");
   ignore_bullet = node.get_bool("ignore_bullet");
   ignore_self_type = node.get_bool("ignore_self_type");
@@ -19,7 +22,7 @@ void Collidable_info::load(CN<Yaml> node) {
 void Collidable_info::accept(Collidable& dst) {
   dst.set_dmg(dmg);
   dst.set_hp(hp);
-  dst.set_explosion_name(exolosion_name);
+  dst.set_explosion(explosion);
   dst.status.ignore_enemy = ignore_enemy;
   dst.status.ignore_bullet = ignore_bullet;
   dst.status.ignore_self_type = ignore_self_type;
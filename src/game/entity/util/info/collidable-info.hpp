@@ -1,6 +1,5 @@
 #pragma once
 #include "game/entity/entity-type.hpp"
-#include "util/str.hpp"
 
 class Yaml;
 class Collidable;
@@ -9,7 +8,7 @@ class Collidable;
 struct Collidable_info {
   hp_t hp {};
   hp_t dmg {};
-  Str exolosion_name {}; /// с каким взрывом объект уничтожится
+  Entity_proto explosion {ENTITY_PROTO_NONE}; /// с каким взрывом объект уничтожится
   bool ignore_enemy {};
   bool ignore_bullet {};
   bool ignore_self_type {};
@@ -71,9 +71,12 @@ void draw_entity_mem_map(Image& dst, const Vec pos) {
   cauto allocated = hpw::entity_mgr->get_entity_pool().allocated();
   txt += U"Allocated: " + n2s<utf32>(allocated) + U" Byte ("
    + n2s<utf32>(scast<double>(allocated) / (1024 * 1024), 2) + U" Mb)\n";
+  cauto reserved = hpw::entity_mgr->get_entity_pool().reserved();
+  txt += U"Reserved: " + n2s<utf32>(reserved) + U" Byte ("
+   + n2s<utf32>(scast<double>(reserved) / (1024 * 1024), 2) + U" Mb)\n";
    txt += U"Lived: " + n2s<utf32>(lived) + U" / " + n2s<utf32>(entities.size()) + U"\n";
 
-  const Vec txt_offset(10, window.size.y - 42);
+  const Vec txt_offset(10, window.size.y - 56);
   graphic::font->draw(dst, pos + txt_offset, txt);
 
 } // draw_entity_mem_map
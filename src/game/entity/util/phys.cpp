@@ -1,105 +1,228 @@
+#include <omp.h>
 #include <algorithm>
 #include <cassert>
 #include "phys.hpp"
+#include "util/vector-types.hpp"
 #include "util/math/vec-util.hpp"
 #include "util/math/mat.hpp"
 #include "util/hpw-util.hpp"
 
-CN<decltype(Phys::m_old_pos)> Phys::get_old_pos() const { return m_old_pos; }
-CN<decltype(Phys::m_pos)> Phys::get_pos() const { return m_pos; }
-CN<decltype(Phys::m_deg)> Phys::get_deg() const { return m_deg; }
-CN<decltype(Phys::m_accel)> Phys::get_accel() const { return m_accel; }
-CN<decltype(Phys::m_force)> Phys::get_force() const { return m_force; }
-CN<decltype(Phys::m_speed)> Phys::get_speed() const { return m_speed; }
-CN<decltype(Phys::m_rotate_speed)> Phys::get_rot_spd() const { return m_rotate_speed; }
-CN<decltype(Phys::m_rotate_accel)> Phys::get_rot_ac() const { return m_rotate_accel; }
-CN<decltype(Phys::m_rotate_force)> Phys::get_rot_fc() const { return m_rotate_force; }
-Vec Phys::get_direction() const { return normalize_stable(get_vel()); }
-void Phys::set_force( CN<decltype(m_force)> _force) { m_force = std::max<decltype(m_force)>(0, _force); }
-CN<decltype(Phys::m_invert_rotation)> Phys::get_invert_rotation() const { return m_invert_rotation; }
-void Phys::set_invert_rotation( CN<decltype(m_invert_rotation)> val) { m_invert_rotation = val; }
-
-Vec Phys::get_vel() const {
-  auto direct = deg_to_vec(m_deg);
-  return direct * m_speed;
-}
+namespace {
+
+/// упакованные массивы кинематики всех Phys, индекс - Phys::m_idx
+struct Phys_store {
+  Vector<real> pos_x {}, pos_y {};
+  Vector<real> old_x {}, old_y {}; /// позиция до последнего шага
+  Vector<real> dir_x {}, dir_y {}; /// единичный вектор направления движения
+  Vector<real> speed {}; /// скорость движения (pps), не меньше нуля
+  Vector<real> accel {}; /// ускорение (pps)
+  Vector<real> force {}; /// торможение (работает как обратный accel)
+  Vector<real> rot_speed {}; /// скорость поворота (pps)
+  Vector<real> rot_accel {}; /// ускорение поворота (pps)
+  Vector<real> rot_force {}; /// замедление поворота
+  Vector<real> deg {}; /// угол по dir, всегда обновляется вместе с dir
+  Vector<real> dt {}; /// запланированный шаг, 0 - объект не двигается
+  Vector<std::uint8_t> invert {}; /// вращаться в обратную сторону
+  Vector<std::uint32_t> free_slots {};
+
+  inline std::size_t size() const { return pos_x.size(); }
+
+  /** массивы общие и без блокировок, поэтому Phys нельзя создавать
+  и удалять в omp-регионах */
+  inline std::uint32_t alloc() {
+    assert( !omp_in_parallel() && "Phys создаётся в omp-регионе");
+    std::uint32_t idx;
+    if ( !free_slots.empty()) {
+      idx = free_slots.back();
+      free_slots.pop_back();
+    } else {
+      idx = size();
+      for (auto arr: {&pos_x, &pos_y, &old_x, &old_y, &dir_x, &dir_y, &speed, &accel,
+      &force, &rot_speed, &rot_accel, &rot_force, &deg, &dt})
+        arr->emplace_back();
+      invert.emplace_back();
+    }
+    reset(idx);
+    return idx;
+  }
 
-void Phys::set_pos( CN<decltype(m_pos)> val) {
-  m_pos = val;
-  m_old_pos = val;
-}
+  inline void free(std::uint32_t idx) {
+    assert( !omp_in_parallel() && "Phys удаляется в omp-регионе");
+    reset(idx);
+    free_slots.push_back(idx);
+  }
 
-void Phys::set_deg( CN<decltype(m_deg)> val) { m_deg = ring_deg(val); }
-void Phys::set_rot_spd( CN<decltype(m_rotate_speed)> val) { m_rotate_speed = val; }
+  /// состояние как у нового Phys: стоит на месте и смотрит на 0 градусов
+  inline void reset(std::uint32_t i) {
+    pos_x[i] = pos_y[i] = old_x[i] = old_y[i] = 0;
+    dir_x[i] = 1;
+    dir_y[i] = 0;
+    speed[i] = accel[i] = force[i] = 0;
+    rot_speed[i] = rot_accel[i] = rot_force[i] = 0;
+    deg[i] = dt[i] = 0;
+    invert[i] = 0;
+  }
 
-void Phys::set_accel( CN<decltype(m_accel)> val) {
-  assert(val >= 0);
-  m_accel = val;
-}
+  inline void copy(std::uint32_t dst, std::uint32_t src) {
+    for (auto arr: {&pos_x, &pos_y, &old_x, &old_y, &dir_x, &dir_y, &speed, &accel,
+    &force, &rot_speed, &rot_accel, &rot_force, &deg, &dt})
+      (*arr)[dst] = (*arr)[src];
+    invert[dst] = invert[src];
+  }
 
-void Phys::set_rot_ac( CN<decltype(m_rotate_accel)> val) {
-  assert(val >= 0);
-  m_rotate_accel = val;
+  inline void set_deg(std::uint32_t i, real val) {
+    deg[i] = ring_deg(val);
+    cauto dir = deg_to_vec(deg[i]);
+    dir_x[i] = dir.x;
+    dir_y[i] = dir.y;
+  }
+}; // Phys_store
+
+/** массивы общие для всех Phys и не удаляются: объекты из статических
+пулов могут умереть позже, чем любой другой static */
+inline Phys_store& store() {
+  static auto instance = new Phys_store;
+  return *instance;
 }
 
-void Phys::set_rot_fc( CN<decltype(m_rotate_force)> val) { m_rotate_force = std::max<decltype(m_rotate_force)>(0, val); }
+/// половина шага вращения. Тригонометрия нужна только тут
+inline void rotate_half(Phys_store& s, std::uint32_t i) {
+  cauto dt = s.dt[i];
+  nauto rot_speed = s.rot_speed[i];
+  return_if (dt == 0 || (rot_speed == 0 && s.rot_accel[i] == 0));
+  rot_speed += s.rot_accel[i] * dt * real(0.5);
+  rot_speed = std::max<real>(0, rot_speed - s.rot_force[i] * dt * real(0.5));
+  s.set_deg(i, s.deg[i] + rot_speed * dt * (s.invert[i] ? real(-1) : real(1)));
+}
 
-void Phys::set_speed( CN<decltype(m_speed)> val) {
-  m_speed = val;
+inline void rotate_pass(Phys_store& s) {
+  cfor (i, s.size())
+    rotate_half(s, i);
+}
 
-  // развернуться, если скорость отрицательная
-  if (m_speed < 0) {
-    m_speed *= -1;
-    set_deg(get_deg() + 180);
+/** шаг движения для [begin, end) без вращения.
+Только +, * и max в одном порядке для всех элементов, поэтому результат
+не зависит от того, попал элемент в SIMD-часть цикла или в хвост.
+Объекты с dt = 0 не меняются */
+void linear_pass(std::size_t begin, std::size_t end,
+const real* __restrict__ dt, const real* __restrict__ dir_x, const real* __restrict__ dir_y,
+const real* __restrict__ accel, const real* __restrict__ force,
+real* __restrict__ speed, real* __restrict__ pos_x, real* __restrict__ pos_y,
+real* __restrict__ old_x, real* __restrict__ old_y) {
+  #pragma omp simd
+  for (std::size_t i = begin; i < end; ++i) {
+    cauto half_dt = dt[i] * real(0.5);
+    cauto active = dt[i] != 0;
+    old_x[i] = active ? pos_x[i] : old_x[i];
+    old_y[i] = active ? pos_y[i] : old_y[i];
+    // движение с ускорением корректным для dt
+    cauto accelerated = speed[i] + accel[i] * half_dt;
+    pos_x[i] += dir_x[i] * accelerated * dt[i];
+    pos_y[i] += dir_y[i] * accelerated * dt[i];
+    // торможение действует на первой половине шага, на второй только ускорение
+    cauto braked = std::max<real>(0, accelerated - force[i] * half_dt);
+    speed[i] = braked + accel[i] * half_dt;
   }
 }
 
-void Phys::set_vel(const Vec val) {
-  auto speed = length(val);
-  // если вектор движения 0, то не менять угол разворота
-  auto deg = val ? vec_to_deg(val) : get_deg();
-
-  set_speed(speed);
-  set_deg(deg);
+/// линейная часть шага по индексам [begin, end)
+inline void linear_pass(Phys_store& s, std::size_t begin, std::size_t end) {
+  linear_pass(begin, end, s.dt.data(), s.dir_x.data(), s.dir_y.data(),
+    s.accel.data(), s.force.data(), s.speed.data(),
+    s.pos_x.data(), s.pos_y.data(), s.old_x.data(), s.old_y.data());
 }
 
-void Phys::update(double dt) {
-  m_old_pos = get_pos();
+} // namespace
 
-  // применение вращения
-  m_rotate_speed += m_rotate_accel * dt * 0.5;
-  m_rotate_speed = std::max<real>(0, m_rotate_speed - m_rotate_force * dt * 0.5);
-  set_deg(m_deg + m_rotate_speed * dt * (m_invert_rotation ? -1.0 : 1.0));
+Phys::Phys(): m_idx {store().alloc()} {}
+Phys::~Phys() { store().free(m_idx); }
+Phys::Phys(CN<Phys> other): Phys() { store().copy(m_idx, other.m_idx); }
 
-  auto vel = get_vel();
-  auto direct = get_direction();
-  auto _force = get_force();
+Phys& Phys::operator = (CN<Phys> other) {
+  if (this != &other)
+    store().copy(m_idx, other.m_idx);
+  return *this;
+}
 
-  // движение с ускорением корректным для dt
-  vel += direct * m_accel * dt * 0.5;
-  set_vel(vel);
+Vec Phys::get_old_pos() const { cnauto s = store(); return Vec(s.old_x[m_idx], s.old_y[m_idx]); }
+Vec Phys::get_pos() const { cnauto s = store(); return Vec(s.pos_x[m_idx], s.pos_y[m_idx]); }
+Vec Phys::get_direction() const { cnauto s = store(); return Vec(s.dir_x[m_idx], s.dir_y[m_idx]); }
+Vec Phys::get_vel() const { return get_direction() * get_speed(); }
+real Phys::get_deg() const { return store().deg[m_idx]; }
+real Phys::get_accel() const { return store().accel[m_idx]; }
+real Phys::get_force() const { return store().force[m_idx]; }
+real Phys::get_speed() const { return store().speed[m_idx]; }
+real Phys::get_rot_spd() const { return store().rot_speed[m_idx]; }
+real Phys::get_rot_ac() const { return store().rot_accel[m_idx]; }
+real Phys::get_rot_fc() const { return store().rot_force[m_idx]; }
+bool Phys::get_invert_rotation() const { return store().invert[m_idx]; }
+
+void Phys::set_pos(const Vec val) {
+  nauto s = store();
+  s.pos_x[m_idx] = s.old_x[m_idx] = val.x;
+  s.pos_y[m_idx] = s.old_y[m_idx] = val.y;
+}
 
-  auto _speed = get_speed();
-  _speed -= _force * dt * 0.5;
-  set_speed(std::max<decltype(_speed)>(0, _speed));
+void Phys::set_deg(real val) { store().set_deg(m_idx, val); }
+void Phys::set_force(real val) { store().force[m_idx] = std::max<real>(0, val); }
+void Phys::set_rot_spd(real val) { store().rot_speed[m_idx] = val; }
+void Phys::set_rot_fc(real val) { store().rot_force[m_idx] = std::max<real>(0, val); }
+void Phys::set_invert_rotation(bool val) { store().invert[m_idx] = val; }
 
-  set_pos( get_pos() + (vel * dt) );
+void Phys::set_accel(real val) {
+  assert(val >= 0);
+  store().accel[m_idx] = val;
+}
 
-  // докручиваем чтоб было ровно по интегралу
-  m_rotate_speed += m_rotate_accel * dt * 0.5;
-  m_rotate_speed = std::max<real>(0, m_rotate_speed - m_rotate_force * dt * 0.5);
-  set_deg(m_deg + m_rotate_speed * dt * (m_invert_rotation ? -1.0 : 1.0));
+void Phys::set_rot_ac(real val) {
+  assert(val >= 0);
+  store().rot_accel[m_idx] = val;
+}
 
-  vel = get_vel();
-  direct = get_direction();
-  vel += direct * m_accel * dt * 0.5;
-  set_vel(vel);
+void Phys::set_speed(real val) {
+  nauto s = store();
+  s.speed[m_idx] = val;
 
-  _speed = get_speed();
-  _speed -= _force * dt * 0.5;
-  set_speed(std::max<decltype(_speed)>(0, _speed));
+  // развернуться, если скорость отрицательная
+  if (val < 0) {
+    s.speed[m_idx] = -val;
+    s.dir_x[m_idx] = -s.dir_x[m_idx];
+    s.dir_y[m_idx] = -s.dir_y[m_idx];
+    s.deg[m_idx] = ring_deg(s.deg[m_idx] + 180);
+  }
+}
 
-  assert(vel >= 0); // может ли случиться иначе?
-  assert(get_deg() >= 0 && get_deg() <= 360);
-  set_vel(vel);
+void Phys::set_vel(const Vec val) {
+  nauto s = store();
+  auto speed = length(val);
+  s.speed[m_idx] = speed;
+  // если вектор движения 0, то не менять направление
+  if (val) {
+    s.dir_x[m_idx] = val.x / speed;
+    s.dir_y[m_idx] = val.y / speed;
+    // угол сразу, чтобы чтение get_deg ничего не меняло и было безопасно из потоков
+    s.deg[m_idx] = ring_deg(vec_to_deg(val));
+  }
+}
+
+void Phys::update(double dt) {
+  nauto s = store();
+  s.dt[m_idx] = dt;
+  // как в update_planned, но для одного индекса
+  rotate_half(s, m_idx);
+  linear_pass(s, m_idx, m_idx + 1);
+  rotate_half(s, m_idx);
+  s.dt[m_idx] = 0;
+  assert(s.speed[m_idx] >= 0);
 } // update
+
+void Phys::plan_update(double dt) { store().dt[m_idx] = dt; }
+
+void Phys::update_planned() {
+  nauto s = store();
+  // вращение нужно редким объектам, а движение - всем
+  rotate_pass(s);
+  linear_pass(s, 0, s.size());
+  rotate_pass(s);
+  std::fill(s.dt.begin(), s.dt.end(), real(0));
+} // update_planned
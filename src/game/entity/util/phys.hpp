@@ -1,46 +1,48 @@
 #pragma once
+#include <cstdint>
 #include "util/math/vec.hpp"
 
-/// Physical context
+/** Physical context.
+Сами данные лежат в общих упакованных массивах (structure of arrays), Phys - индекс в них.
+Скорость хранится как единичный вектор направления и модуль, угол обновляется вместе с ним.
+Чтение только читает, поэтому геттеры можно звать из omp-регионов, а создание и удаление - нет */
 class Phys final {
-  Vec m_old_pos {}; /// старая позиция
-  Vec m_pos {}; /// позиция
-  real m_speed {}; /// скорость движения (pps)
-  real m_accel {}; /// ускорение (pps)
-  real m_force {}; /// торможение (работает как обратный m_accel)
-  real m_deg {}; /// degree (0..360)
-  real m_rotate_speed {}; /// скорость поворота (pps)
-  real m_rotate_accel {}; /// ускорение поворота (pps)
-  real m_rotate_force {}; /// замедление поворота
-  bool m_invert_rotation {}; /// вращаться в обратную сторону
+  std::uint32_t m_idx {}; /// индекс в массивах кинематики
 
 public:
-  Phys() = default;
-  ~Phys() = default;
+  Phys();
+  ~Phys();
+  Phys(CN<Phys> other);
+  Phys& operator = (CN<Phys> other);
 
-  CN<decltype(m_old_pos)> get_old_pos() const;
-  CN<decltype(m_pos)> get_pos() const;
+  Vec get_old_pos() const;
+  Vec get_pos() const;
   Vec get_vel() const;
   Vec get_direction() const;
-  CN<decltype(m_deg)> get_deg() const;
-  CN<decltype(m_accel)> get_accel() const;
-  CN<decltype(m_force)> get_force() const;
-  CN<decltype(m_speed)> get_speed() const;
-  CN<decltype(m_rotate_speed)> get_rot_spd() const; /// get rotation m_speed
-  CN<decltype(m_rotate_accel)> get_rot_ac() const; /// get rotation m_accel
-  CN<decltype(m_rotate_force)> get_rot_fc() const; /// get rotation m_force
-  CN<decltype(m_invert_rotation)> get_invert_rotation() const;
-  
-  void set_pos( CN<decltype(m_pos)> val);
-  void set_vel( const Vec val);
-  void set_deg( CN<decltype(m_deg)> val);
-  void set_accel( CN<decltype(m_accel)> val);
-  void set_force( CN<decltype(m_force)> val);
-  void set_speed( CN<decltype(m_speed)> val);
-  void set_rot_spd( CN<decltype(m_rotate_speed)> val); /// set rotation m_speed
-  void set_rot_ac( CN<decltype(m_rotate_accel)> val); /// set rotation m_accel
-  void set_rot_fc( CN<decltype(m_rotate_force)> val); /// set rotation m_force
-  void set_invert_rotation( CN<decltype(m_invert_rotation)> val);
+  real get_deg() const; /// degree (0..360)
+  real get_accel() const; /// ускорение (pps)
+  real get_force() const; /// торможение (работает как обратный accel)
+  real get_speed() const; /// скорость движения (pps)
+  real get_rot_spd() const; /// get rotation speed
+  real get_rot_ac() const; /// get rotation accel
+  real get_rot_fc() const; /// get rotation force
+  bool get_invert_rotation() const;
 
+  void set_pos(const Vec val);
+  void set_vel(const Vec val);
+  void set_deg(real val);
+  void set_accel(real val);
+  void set_force(real val);
+  void set_speed(real val);
+  void set_rot_spd(real val); /// set rotation speed
+  void set_rot_ac(real val); /// set rotation accel
+  void set_rot_fc(real val); /// set rotation force
+  void set_invert_rotation(bool val); /// вращаться в обратную сторону
+
+  /// сразу сделать шаг только для этого объекта
   void update(double dt);
+  /// запланировать шаг для update_planned
+  void plan_update(double dt);
+  /// шаг всех запланированных объектов одним проходом по массивам
+  static void update_planned();
 }; // Phys
@@ -1,5 +1,6 @@
 #include <cassert>
 #include <algorithm>
+#include <type_traits>
 #include "game-app.hpp"
 #include "host/command.hpp"
 #include "game/util/pge.hpp"
@@ -7,6 +8,10 @@
 #include "game/core/scenes.hpp"
 #include "game/scene/scene-main-menu.hpp"
 #include "game/scene/scene-manager.hpp"
+#include "game/scene/scene-loading.hpp"
+#include "game/scene/scene-game.hpp"
+#include "game/core/replays.hpp"
+#include "game/util/replay.hpp"
 #include "game/core/core.hpp"
 #include "game/core/fonts.hpp"
 #include "game/core/canvas.hpp"
@@ -28,8 +33,17 @@
 #include "util/hpw-util.hpp"
 #include "util/log.hpp"
 
-Game_app::Game_app(int argc, char *argv[])
-: Host_glfw(argc, argv)
+/// путь до реплея, если хост его запускает сам
+template <class Host_base>
+static Str autostart_replay(CN<Host_base> host) {
+  if constexpr (std::is_same_v<Host_base, Host_headless>)
+    return host.get_config().replay;
+  return {};
+}
+
+template <class Host_base>
+Game_app_base<Host_base>::Game_app_base(int argc, char *argv[])
+: Host_base(argc, argv)
 {
   #ifdef RELEASE
     init_validation_info();
@@ -40,7 +54,11 @@ Game_app::Game_app(int argc, char *argv[])
   load_font();
   
   init_scene_mgr();
-  hpw::scene_mgr->add( new_shared<Scene_main_menu>() );
+  // без главного меню: когда реплей кончится, кончатся и сцены
+  if (cauto replay_path = autostart_replay<Host_base>(*this); !replay_path.empty())
+    start_replay(replay_path);
+  else
+    hpw::scene_mgr->add( new_shared<Scene_main_menu>() );
 
   /* к этому моменту кеймапер будет инициализирован и
   управление можно будет переназначить с конфига */
@@ -48,57 +66,77 @@ Game_app::Game_app(int argc, char *argv[])
   load_pge_from_config();
 } // c-tor
 
-Game_app::~Game_app() {
+template <class Host_base>
+Game_app_base<Host_base>::~Game_app_base() {
   disable_pge();
   hpw::scene_mgr = {};
 }
 
-void Game_app::update(double dt) {
+template <class Host_base>
+void Game_app_base<Host_base>::update(double dt) {
   ALLOW_STABLE_RAND
   assert(dt == hpw::target_update_time);
   update_graphic_autoopt(dt);
   
-  Host_glfw::update(dt);
+  Host_base::update(dt);
 
-  auto st = get_time();
+  auto st = this->get_time();
   if ( !hpw::scene_mgr->update(dt) ) {
     detailed_log("scenes are over, call soft_exit\n");
     hpw::soft_exit();
   }
-  hpw::update_time_unsafe = get_time() - st;
+  hpw::update_time_unsafe = this->get_time() - st;
 } // update
 
-void Game_app::draw_game_frame() {
-  auto st = get_time();
+template <class Host_base>
+void Game_app_base<Host_base>::draw_game_frame() {
+  auto st = this->get_time();
 
   hpw::scene_mgr->draw(*graphic::canvas);
   if (graphic::draw_border) // рамка по краям
     draw_border(*graphic::canvas);
   apply_pge(graphic::frame_count);
 
-  graphic::soft_draw_time = get_time() - st;
+  graphic::soft_draw_time = this->get_time() - st;
   graphic::check_autoopt();
 }
 
-void Game_app::draw_border(Image& dst) const
+template <class Host_base>
+void Game_app_base<Host_base>::draw_border(Image& dst) const
   { draw_rect(dst, Rect{0,0, dst.X, dst.Y}, Pal8::white); }
 
-void Game_app::load_locale() {
+template <class Host_base>
+void Game_app_base<Host_base>::load_locale() {
   auto path = (*hpw::config)["path"].get_str("locale", "resource/locale/en.yml");
   auto mem = hpw::archive->get_file(path);
   auto yml = Yaml(mem);
   load_locales_to_store(yml);
 }
 
-void Game_app::load_font() {
+template <class Host_base>
+void Game_app_base<Host_base>::load_font() {
   auto mem {hpw::archive->get_file("resource/font/unifont-13.0.06.ttf")};
   graphic::font = new_shared<Unifont>(mem, 16, true);
 }
 
-void Game_app::update_graphic_autoopt(double dt) {
+template <class Host_base>
+void Game_app_base<Host_base>::update_graphic_autoopt(double dt) {
   using timeout_t = decltype(graphic::autoopt_timeout);
   // если рендер не будет лагать, то после таймера - тригер автооптимизации сбросится
   graphic::autoopt_timeout = std::max(graphic::autoopt_timeout - dt, timeout_t(0));
   if (graphic::autoopt_timeout == timeout_t(0))
     graphic::render_lag = false;
 }
+
+template <class Host_base>
+void Game_app_base<Host_base>::start_replay(CN<Str> path) {
+  cauto info = Replay::get_info(path);
+  hpw::scene_mgr->add(new_shared<Scene_loading>( [info] {
+    hpw::replay_read_mode = true;
+    hpw::cur_replay_file_name = info.path;
+    hpw::scene_mgr->add(new_shared<Scene_game>(info.first_level_is_tutorial));
+  } ));
+}
+
+template class Game_app_base<Host_glfw>;
+template class Game_app_base<Host_headless>;
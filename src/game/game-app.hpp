@@ -1,11 +1,15 @@
 #pragma once
 #include "host/host-glfw.hpp"
+#include "host/host-headless.hpp"
 
 class Image;
 
-class Game_app: public Host_glfw {
-  nocopy(Game_app);
-  
+/** игра поверх любого хоста.
+Host_glfw - обычный запуск с окном, Host_headless - без окна и GPU */
+template <class Host_base>
+class Game_app_base: public Host_base {
+  nocopy(Game_app_base);
+
   void update(double dt) override;
   void load_locale();
   void load_font();
@@ -13,9 +17,13 @@ class Game_app: public Host_glfw {
   /// полноэкранная рамка
   void draw_border(Image& dst) const;
   void draw_game_frame() override;
+  /// сразу запустить реплей без главного меню
+  void start_replay(CN<Str> path);
 
 public:
-  explicit Game_app(int argc, char *argv[]);
-  ~Game_app();
-}; // Game_app
+  explicit Game_app_base(int argc, char *argv[]);
+  ~Game_app_base();
+}; // Game_app_base
 
+using Game_app = Game_app_base<Host_glfw>;
+using Game_app_headless = Game_app_base<Host_headless>;
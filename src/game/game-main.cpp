@@ -1,6 +1,12 @@
 #include "game-app.hpp"
 
 int main(int argc, char *argv[]) {
+  if (is_headless_launch(argc, argv)) {
+    Game_app_headless app(argc, argv);
+    app.run();
+    return app.get_exit_code();
+  }
+
   Game_app app(argc, argv);
   app.run();
   return EXIT_SUCCESS;
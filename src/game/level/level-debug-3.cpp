@@ -23,7 +23,7 @@
 #include "game/entity/util/anim-ctx.hpp"
 #include "game/entity/util/entity-util.hpp"
 #include "game/entity/particle.hpp"
-#include "game/entity/collider/collider-qtree.hpp"
+#include "game/entity/collider/collider-util.hpp"
 #include "game/level/level-manager.hpp"
 //#include "game/entity/collider/collider-simple.hpp"
 
@@ -72,7 +72,7 @@ Level_debug_3::Level_debug_3()
   make_player();
   make_dummy();
   impl->make_bg();
-  hpw::entity_mgr->set_collider(new_shared<Collider_qtree>(6, 1, graphic::canvas->X, graphic::canvas->Y));
+  hpw::entity_mgr->set_collider(make_collider(graphic::canvas->X, graphic::canvas->Y));
   //hpw::entity_mgr->set_collider(new_shared<Collider_simple>());
 } // c-tor
 
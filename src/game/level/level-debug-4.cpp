@@ -20,14 +20,13 @@
 #include "game/entity/util/anim-ctx.hpp"
 #include "game/entity/util/entity-util.hpp"
 #include "game/entity/particle.hpp"
-#include "game/entity/collider/collider-qtree.hpp"
+#include "game/entity/collider/collider-util.hpp"
 #include "game/level/level-manager.hpp"
 
 struct Level_debug_4::Impl {
   inline Impl() {
     make_player();
-    hpw::entity_mgr->set_collider(new_shared<Collider_qtree>(6, 1,
-      graphic::canvas->X, graphic::canvas->Y));
+    hpw::entity_mgr->set_collider(make_collider(graphic::canvas->X, graphic::canvas->Y));
   }
 
   inline void update(const Vec vel, double dt) {
@@ -3,7 +3,7 @@
 #include "game/core/entities.hpp"
 #include "game/entity/util/phys.hpp"
 #include "game/entity/entity-manager.hpp"
-#include "game/entity/collider/collider-qtree.hpp"
+#include "game/entity/collider/collider-util.hpp"
 #include "graphic/image/image.hpp"
 #include "util/math/vec.hpp"
 #include "util/math/timer.hpp"
@@ -13,8 +13,7 @@ struct Level_debug_bullets::Impl {
   Timer shoot_timer {0.5};
 
   inline Impl() {
-    hpw::entity_mgr->set_collider(new_shared<Collider_qtree>(6, 1,
-      graphic::canvas->X, graphic::canvas->Y));
+    hpw::entity_mgr->set_collider(make_collider(graphic::canvas->X, graphic::canvas->Y));
   }
 
   inline void update(const Vec vel, double dt) {
@@ -13,7 +13,7 @@
 #include "game/entity/util/anim-ctx.hpp"
 #include "game/entity/util/entity-util.hpp"
 //#include "game/entity/collider/collider-simple.hpp"
-#include "game/entity/collider/collider-qtree.hpp"
+#include "game/entity/collider/collider-util.hpp"
 #include "game/util/game-util.hpp"
 #include "game/util/keybits.hpp"
 #include "game/core/entities.hpp"
@@ -24,7 +24,7 @@
 Level_debug::Level_debug() {
   hitbox_test();
   //hpw::entity_mgr->set_collider(  new_shared<Collider_simple>() );
-  hpw::entity_mgr->set_collider( new_shared<Collider_qtree>(6, 1, graphic::canvas->X, graphic::canvas->Y) );
+  hpw::entity_mgr->set_collider( make_collider(graphic::canvas->X, graphic::canvas->Y) );
   set_rnd_seed(97997);
 
   // сделать рандомные объекты
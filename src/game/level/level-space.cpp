@@ -13,7 +13,7 @@
 #include "game/level/level-manager.hpp"
 #include "game/util/game-util.hpp"
 #include "game/core/entities.hpp"
-#include "game/entity/collider/collider-qtree.hpp"
+#include "game/entity/collider/collider-util.hpp"
 #include "game/entity/entity-manager.hpp"
 #include "game/entity/player.hpp"
 #include "game/entity/util/entity-util.hpp"
@@ -94,8 +94,7 @@ struct Level_space::Impl {
   }
 
   inline void init_collider() {
-    hpw::entity_mgr->set_collider(new_shared<Collider_qtree>(6, 1,
-      graphic::width, graphic::height));
+    hpw::entity_mgr->set_collider(make_collider(graphic::width, graphic::height));
   }
 
   /// наполнение уровня тригерами
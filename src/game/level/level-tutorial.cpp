@@ -5,7 +5,7 @@
 #include "util/hpw-util.hpp"
 #include "game/entity/player.hpp"
 #include "game/entity/entity-manager.hpp"
-#include "game/entity/collider/collider-qtree.hpp"
+#include "game/entity/collider/collider-util.hpp"
 #include "game/entity/util/entity-util.hpp"
 #include "game/core/entities.hpp"
 #include "game/core/canvas.hpp"
@@ -61,8 +61,7 @@ struct Level_tutorial::Impl {
     { hpw::entity_mgr->make({}, "player.boo.dark", get_screen_center() + Vec(0, 100)); }
 
   inline void init_collider() {
-    hpw::entity_mgr->set_collider(new_shared<Collider_qtree>(6, 1,
-      graphic::width, graphic::height));
+    hpw::entity_mgr->set_collider(make_collider(graphic::width, graphic::height));
   }
 
   inline void init_tasks() {
@@ -15,6 +15,7 @@
 
 struct Tile {
   Weak<Sprite> sprite {}; /// текстура с банка
+  Borrow<Sprite> view {}; /// та же текстура для отрисовки в потоках, пока sprite жив
   Vec offset {};
 };
 
@@ -57,6 +58,7 @@ struct Tilemap::Impl {
       iferror(!sprite, "sprite \"" << sprite_fname << "\" not founded in sprite_store");
       m_tiles.emplace_back( std::move( Tile{
         .sprite = sprite,
+        .view = borrow(sprite),
         .offset = offset
       } ) );
     } // for tile names
@@ -70,12 +72,14 @@ struct Tilemap::Impl {
 
   inline void draw(const Vec pos, Image& dst, blend_pf bf=&blend_past, int optional=0) const {
     assert(!m_tiles.empty());
+    // проверка в главном потоке, в omp-цикле счётчики ссылок не трогаются
+    for (cnauto tile: m_tiles)
+      iferror(tile.sprite.expired(), "tile.sprite bad ptr");
 
     #pragma omp parallel for schedule(dynamic)
     for (cnauto tile: m_tiles) {
-      iferror(tile.sprite.expired(), "tile.sprite bad ptr");
       // TODO не рисовать за экраном
-      insert(dst, *tile.sprite.lock(), pos + tile.offset, bf, optional);
+      insert(dst, *tile.view, pos + tile.offset, bf, optional);
     }
   }
 
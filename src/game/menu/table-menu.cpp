@@ -1,5 +1,6 @@
 #include <cassert>
 #include <cmath>
+#include <algorithm>
 #include "table-menu.hpp"
 #include "graphic/image/image.hpp"
 #include "graphic/util/util-templ.hpp"
@@ -8,6 +9,8 @@
 #include "item/table-row-item.hpp"
 #include "game/core/fonts.hpp"
 #include "game/util/game-util.hpp"
+#include "game/util/keybits.hpp"
+#include "game/core/canvas.hpp"
 
 struct Table_menu::Impl {
   Menu* m_base {};
@@ -37,11 +40,18 @@ struct Table_menu::Impl {
     #endif
   } // Impl c-tor
 
+  constx uint TABLE_OFFSET_Y = 28;
+
   inline void draw(Image& dst) const {
     dst.fill(Pal8::black);
     graphic::font->draw(dst, Vec(8, 8), m_title);
-    cauto table_offset_y = 28u;
-    draw_table(dst, table_offset_y);
+    draw_table(dst, TABLE_OFFSET_Y);
+  }
+
+  /// сколько строк таблицы влезает на экран под заголовком
+  inline std::size_t page_size() const {
+    cauto rows_h = std::max<int>(0, graphic::height - TABLE_OFFSET_Y - m_row_height);
+    return std::max<std::size_t>(1, rows_h / (m_row_height - 1));
   }
 
   inline void draw_table(Image& dst, const uint table_offset_y) const {
@@ -117,4 +127,15 @@ CN<Menu_items> items)
 {}
 
 void Table_menu::draw(Image& dst) const { impl->draw(dst); }
+
+void Table_menu::update(double dt) {
+  Menu::update(dt);
+  return_if(m_items.empty());
+
+  cauto page = impl->page_size();
+  if (is_pressed_once(hpw::keycode::right))
+    m_cur_item = std::min(m_cur_item + page, m_items.size() - 1);
+  if (is_pressed_once(hpw::keycode::left))
+    m_cur_item = m_cur_item > page ? m_cur_item - page : 0;
+}
 Table_menu::~Table_menu() {}
@@ -21,4 +21,6 @@ public:
   explicit Table_menu(CN<utf32> title, CN<Rows> rows, const uint row_height,
     CN<Menu_items> items);
   void draw(Image& dst) const override;
+  /// влево/вправо листают таблицу по страницам
+  void update(double dt) override;
 };
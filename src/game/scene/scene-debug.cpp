@@ -4,6 +4,7 @@
 #include "game/core/entities.hpp"
 #include "game/core/core.hpp"
 #include "game/core/debug.hpp"
+#include "game/core/canvas.hpp"
 #include "game/core/scenes.hpp"
 #include "game/util/sync.hpp"
 #include "game/util/keybits.hpp"
@@ -12,8 +13,10 @@
 #include "game/menu/item/text-item.hpp"
 #include "game/menu/item/bool-item.hpp"
 #include "game/menu/item/int-item.hpp"
+#include "game/menu/item/list-item.hpp"
 #include "game/entity/player.hpp"
 #include "game/entity/entity-manager.hpp"
+#include "game/entity/collider/collider-util.hpp"
 #include "graphic/font/unifont.hpp"
 #include "graphic/image/image.hpp"
 #include "graphic/font/font.hpp"
@@ -38,6 +41,13 @@ void Scene_debug::draw(Image& dst) const {
   menu->draw(dst);
 }
 
+/// сменить обработчик столкновений прямо во время игры
+static void set_collider(const Collider_type type) {
+  hpw::collider_type = type;
+  if (hpw::entity_mgr)
+    hpw::entity_mgr->set_collider(make_collider(graphic::width, graphic::height));
+}
+
 void Scene_debug::init_menu() {
   menu = new_shared<Text_menu>(
     Menu_items {
@@ -79,6 +89,14 @@ void Scene_debug::init_menu() {
         [] { return graphic::show_grids; },
         [] (bool new_val) { graphic::show_grids = new_val; }
       ),
+      new_shared<Menu_list_item>(U"Collider",
+        Menu_list_item::Items {
+          Menu_list_item::Item { .name = U"quad tree", .action = []{ set_collider(Collider_type::qtree); } },
+          Menu_list_item::Item { .name = U"grid", .action = []{ set_collider(Collider_type::grid); } },
+          Menu_list_item::Item { .name = U"simple", .action = []{ set_collider(Collider_type::simple); } },
+        },
+        scast<std::size_t>(hpw::collider_type)
+      ),
       new_shared<Menu_bool_item>(U"Inputs",
         [] { return graphic::draw_controls; },
         [] (bool new_val) { graphic::draw_controls = new_val; }
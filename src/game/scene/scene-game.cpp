@@ -101,6 +101,9 @@ Scene_game::Scene_game(const bool start_tutorial)
 }
 
 Scene_game::~Scene_game() {
+  // последнее состояние, пока объекты ещё живы
+  if (m_replay_read)
+    replay_hash_update();
   if (graphic::get_fast_forward())
     graphic::set_fast_forward(false);
   graphic::post_effects = {};
@@ -130,7 +133,8 @@ void Scene_game::update(double dt) {
   else if (hpw::enable_replay)
     replay_save_keys();
 
-  hpw::level_mgr->update(get_level_vel(), dt);
+  hpw::profiled_call(hpw::update_profile.level,
+    [&] { hpw::level_mgr->update(get_level_vel(), dt); });
   if (hpw::level_mgr->end_of_levels) {
     hpw::scene_mgr->back(); // exit to loading screen
     hpw::scene_mgr->back(); // exit to diffuculty
@@ -139,12 +143,20 @@ void Scene_game::update(double dt) {
   }
 
   if (graphic::hud)
-    graphic::hud->update(dt);
-  hpw::entity_mgr->update(dt);
-  graphic::camera->update(dt);
-  graphic::post_effects->update(dt);
+    hpw::profiled_call(hpw::update_profile.hud, [&] { graphic::hud->update(dt); });
+  hpw::profiled_call(hpw::update_profile.entities, [&] { hpw::entity_mgr->update(dt); });
+  hpw::profiled_call(hpw::update_profile.camera, [&] { graphic::camera->update(dt); });
+  hpw::profiled_call(hpw::update_profile.post_effects,
+    [&] { graphic::post_effects->update(dt); });
   
   ++hpw::game_updates_safe;
+  if (m_replay_read) {
+    if ((hpw::game_updates_safe % REPLAY_HASH_PERIOD) == 0)
+      replay_hash_update();
+  } else if (hpw::enable_replay) {
+    if ((hpw::game_updates_safe % (REPLAY_CHECKPOINT_PERIOD * hpw::target_ups)) == 0)
+      replay_save_checkpoint();
+  }
 
   #ifdef STABLE_REPLAY
     if ((hpw::game_updates_safe % 72) == 0)
@@ -239,17 +251,42 @@ void Scene_game::replay_init() {
     detailed_log("назначен новый сид рандома: " << seed << '\n');
   #endif
 
+  m_replay_read = hpw::replay_read_mode;
+  hpw::replay_state_hash = 0;
+  hpw::replay_desync_tick = 0;
   if (hpw::replay_read_mode)
     replay = new_unique<Replay>(hpw::cur_replay_file_name, false);
   else if (hpw::enable_replay)
     replay = new_unique<Replay>(hpw::cur_dir + "replays/last_replay.hpw_replay", true);
 } // replay_init
 
+void Scene_game::replay_save_checkpoint() {
+  replay->push_checkpoint( Replay::Checkpoint {
+    .tick = hpw::game_updates_safe,
+    .state_hash = game_state_hash()
+  } );
+}
+
+void Scene_game::replay_check_desync() {
+  // точка записана в конце прошлого апдейта, с тех пор состояние не менялось
+  cauto checkpoint = replay->pop_checkpoint();
+  return_if ( !checkpoint);
+  return_if (hpw::replay_desync_tick != 0); // достаточно первого расхождения
+  if (checkpoint->tick != hpw::game_updates_safe || checkpoint->state_hash != game_state_hash()) {
+    hpw::replay_desync_tick = checkpoint->tick;
+    hpw_log("рассинхрон реплея на апдейте " << checkpoint->tick << '\n');
+  }
+}
+
+void Scene_game::replay_hash_update() {
+  hpw::replay_state_hash = hpw::replay_state_hash * 0x100000001b3ull ^ game_state_hash();
+}
+
 void Scene_game::replay_save_keys() {
-  Key_packet packet;
+  m_key_packet.clear();
 
   #define check_key(key) if (is_pressed(key)) \
-    packet.emplace_back(key);
+    m_key_packet.emplace_back(key);
   check_key(hpw::keycode::up)
   check_key(hpw::keycode::down)
   check_key(hpw::keycode::left)
@@ -261,7 +298,7 @@ void Scene_game::replay_save_keys() {
   check_key(hpw::keycode::shoot)
   #undef check_key
 
-  replay->push( std::move(packet) );
+  replay->push(m_key_packet);
 }
 
 void Scene_game::replay_load_keys() {
@@ -270,9 +307,10 @@ void Scene_game::replay_load_keys() {
   hpw::any_key_pressed = false;
 
   // прочитать клавиши с реплея
-  auto key_packet = replay->pop();
-  if (key_packet) {
-    for (cnauto key: *key_packet) {
+  cauto has_keys = replay->pop(m_key_packet);
+  replay_check_desync();
+  if (has_keys) {
+    for (cnauto key: m_key_packet) {
       press(key);
       hpw::any_key_pressed = true;
     }
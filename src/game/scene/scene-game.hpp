@@ -1,6 +1,9 @@
 #pragma once
 #include "scene.hpp"
+#include "util/macro.hpp"
 #include "util/mem-types.hpp"
+#include "util/vector-types.hpp"
+#include "game/util/keybits.hpp"
 
 struct Vec;
 class Replay;
@@ -9,6 +12,12 @@ class Replay;
 class Scene_game final: public Scene {
   Unique<Replay> replay {};
   bool m_start_tutorial {false};
+  bool m_replay_read {false}; /// сцена проигрывает реплей
+  Vector<hpw::keycode> m_key_packet {}; /// клавиши текущего апдейта для реплея, память переиспользуется
+  /// раз в столько апдейтов состояние игры добавляется в хэш реплея
+  constx unsigned REPLAY_HASH_PERIOD = 72;
+  /// раз в столько секунд игры в реплей пишется контрольная точка
+  constx unsigned REPLAY_CHECKPOINT_PERIOD = 5;
 
   void draw_debug_info(Image& dst) const;
   void init_levels();
@@ -16,6 +25,9 @@ class Scene_game final: public Scene {
   void replay_init();
   void replay_save_keys();
   void replay_load_keys();
+  void replay_hash_update();
+  void replay_save_checkpoint();
+  void replay_check_desync();
   void post_draw(Image& dst) const;
   void draw_border(Image& dst) const; /// рамка по краям экрана
   Vec get_level_vel() const; /// безопасно получить сдвиг кординат уровня
@@ -1,4 +1,7 @@
 #include <cassert>
+#include <optional>
+#include <algorithm>
+#include <filesystem>
 #include "scene-replay-select.hpp"
 #include "scene-manager.hpp"
 #include "scene-loading.hpp"
@@ -18,8 +21,16 @@
 #include "util/error.hpp"
 
 struct Scene_replay_select::Impl {
+  /// реплей в списке. Заголовок читается, только когда строка попала на экран
+  struct Entry {
+    Str path {};
+    std::filesystem::file_time_type mtime {};
+    std::optional<Replay::Info> info {};
+    bool broken {}; /// заголовок не прочитался
+  };
+
   Unique<Menu> menu {};
-  Vector<Replay::Info> m_replay_info_table {};
+  Vector<Entry> m_entries {};
 
   inline Impl() {
     init_menu();
@@ -52,70 +63,89 @@ struct Scene_replay_select::Impl {
   } // init_menu
 
   inline Menu_items generate_rows() {
-    return_if(m_replay_info_table.empty(), {});
-    // сортировать реплеи по дате создания
-    std::sort(m_replay_info_table.begin(), m_replay_info_table.end(),
-      &Impl::date_comparator);
-
     Menu_items ret;
-    for (cnauto replay_info: m_replay_info_table) {
+    ret.reserve(m_entries.size());
+    cfor (idx, m_entries.size()) {
       ret.emplace_back( new_shared<Menu_item_table_row>(
-        [replay_info] { // запуск файла реплея
-          assert(!replay_info.path.empty());
-          hpw::scene_mgr->add(new_shared<Scene_loading>( [replay_info]{
-            hpw::replay_read_mode = true;
-            hpw::cur_replay_file_name = replay_info.path;
-            hpw::scene_mgr->add (
-              new_shared<Scene_game>(replay_info.first_level_is_tutorial)
-            );
-          } ));
-        },
+        [this, idx] { start_replay(idx); },
         Menu_item_table_row::Content_getters {
-          [replay_info]->utf32 { return replay_info.player_name; },
-          [replay_info]->utf32 { return sconv<utf32>(replay_info.date_str); },
-          [replay_info]->utf32 { return difficulty_to_str(replay_info.difficulty); },
-          [replay_info]->utf32 { return n2s<utf32>(replay_info.score); },
+          [this, idx]->utf32 {
+            cauto info = get_info(idx);
+            // у битого реплея показать хотя бы имя файла
+            return_if ( !info, sconv<utf32>(get_filename(m_entries[idx].path)));
+            // старый реплей виден в списке, но не запускается
+            return info->old_rng ? U"[v3] " + info->player_name : info->player_name;
+          },
+          [this, idx]->utf32 {
+            cauto info = get_info(idx);
+            return info ? sconv<utf32>(info->date_str) : utf32{};
+          },
+          [this, idx]->utf32 {
+            cauto info = get_info(idx);
+            return info ? difficulty_to_str(info->difficulty) : utf32{};
+          },
+          [this, idx]->utf32 {
+            cauto info = get_info(idx);
+            return info ? n2s<utf32>(info->score) : utf32{};
+          },
         }
       ) );
     }
     return ret;
   } // generate_rows
 
+  /// запуск файла реплея
+  inline void start_replay(const std::size_t idx) {
+    cauto info = get_info(idx);
+    return_if (!info);
+    assert(!info->path.empty());
+    if (info->old_rng) {
+      hpw_log("реплей \"" << info->path << "\" записан до потоков рандома "
+        "у объектов (v3.x) и не проигрывается этой версией игры\n");
+      return;
+    }
+    hpw::scene_mgr->add(new_shared<Scene_loading>( [replay_info = *info]{
+      hpw::replay_read_mode = true;
+      hpw::cur_replay_file_name = replay_info.path;
+      hpw::scene_mgr->add (
+        new_shared<Scene_game>(replay_info.first_level_is_tutorial)
+      );
+    } ));
+  }
+
+  /// список файлов без чтения, новые реплеи сверху
   inline void load_replays() {
+    namespace fs = std::filesystem;
     cauto replay_files = files_in_dir(hpw::cur_dir + "replays/");
-    return_if(replay_files.empty());
+    m_entries.reserve(replay_files.size());
     for (cnauto replay_file: replay_files) {
       try {
-        cauto info = Replay::get_info(replay_file);
-        m_replay_info_table.push_back(info);
+        m_entries.push_back(Entry {.path = replay_file, .mtime = fs::last_write_time(replay_file)});
+      } catch (CN<fs::filesystem_error> error) {
+        hpw_log("не удалось загрузить один из реплеев: " << error.what() << "\n");
+      }
+    }
+    // дата записи берётся у файла, чтобы не открывать каждый реплей
+    std::sort(m_entries.begin(), m_entries.end(),
+      [](CN<Entry> a, CN<Entry> b) { return a.mtime > b.mtime; });
+  } // load_replays
+
+  /// заголовок реплея читается при первом обращении
+  inline CP<Replay::Info> get_info(const std::size_t idx) {
+    nauto entry = m_entries.at(idx);
+    if ( !entry.info && !entry.broken) {
+      try {
+        entry.info = Replay::get_info(entry.path);
       } catch (CN<hpw::Error> error) {
         hpw_log("не удалось загрузить один из реплеев: " << error.what() << "\n");
+        entry.broken = true;
       } catch (...) {
         hpw_log("не удалось загрузить один из реплеев\n");
+        entry.broken = true;
       }
     }
-  } // load_replays
-
-  /// для сравнения времени создания реплея
-  inline static bool date_comparator(CN<Replay::Info> a, CN<Replay::Info> b) {
-    // год
-    if (a.date.year < b.date.year) return false;
-    if (a.date.year > b.date.year) return true;
-    // месяц
-    if (a.date.month < b.date.month) return false;
-    if (a.date.month > b.date.month) return true;
-    // день
-    if (a.date.day < b.date.day) return false;
-    if (a.date.day > b.date.day) return true;
-    // час
-    if (a.date.hour < b.date.hour) return false;
-    if (a.date.hour > b.date.hour) return true;
-    // минута
-    if (a.date.minute < b.date.minute) return false;
-    if (a.date.minute > b.date.minute) return true;
-    // секунда
-    return a.date.second > b.date.second;
-  } // date_comparator
+    return entry.info ? &*entry.info : nullptr;
+  } // get_info
 }; // impl
 
 Scene_replay_select::Scene_replay_select(): impl {new_unique<Impl>()} {}
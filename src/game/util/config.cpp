@@ -26,6 +26,7 @@ int get_scancode(const hpw::keycode keycode) {
 void save_config() {
   auto& config = *hpw::config;
   config.set_bool("enable_replay", hpw::enable_replay);
+  config.set_bool("compress_replay", hpw::compress_replay);
   config.set_bool("need_tutorial", hpw::need_tutorial);
 
   auto graphic_node = config.make_node("graphic");
@@ -47,6 +48,7 @@ void save_config() {
   graphic_node.set_bool ("auto_frame_skip",     graphic::auto_frame_skip);
   graphic_node.set_bool ("enable_heat_distort", graphic::enable_heat_distort);
   graphic_node.set_bool ("disable_heat_distort_while_lag", graphic::disable_heat_distort_while_lag);
+  graphic_node.set_bool ("enable_rotsprite_cache", graphic::enable_rotsprite_cache);
   graphic_node.set_real ("gamma",               graphic::gamma);
 
   auto sync_node = graphic_node.make_node("sync");
@@ -54,6 +56,7 @@ void save_config() {
   sync_node.set_bool ("wait_frame",            graphic::wait_frame);
   sync_node.set_int  ("target_fps",            graphic::get_target_fps());
   sync_node.set_bool ("cpu_safe",              graphic::cpu_safe);
+  sync_node.set_bool ("render_thread",         graphic::render_thread);
   sync_node.set_real ("autoopt_timeout_max",   graphic::autoopt_timeout_max);
   sync_node.set_bool("disable_frame_limit",    graphic::get_disable_frame_limit());
 
@@ -81,6 +84,7 @@ void load_config() {
 
   auto& config = *hpw::config;
   hpw::enable_replay = config.get_bool("enable_replay", true);
+  hpw::compress_replay = config.get_bool("compress_replay", true);
   hpw::need_tutorial = config.get_bool("need_tutorial", true);
 
   auto path_node = config["path"];
@@ -108,6 +112,7 @@ void load_config() {
   graphic::blur_quality_mul = graphic_node.get_real("blur_quality_mul", graphic::blur_quality_mul);
   graphic::blink_particles = graphic_node.get_bool("blink_particles", graphic::blink_particles);
   graphic::blink_motion_blur = graphic_node.get_bool("blink_motion_blur", graphic::blink_motion_blur);
+  graphic::enable_rotsprite_cache = graphic_node.get_bool("enable_rotsprite_cache", graphic::enable_rotsprite_cache);
   graphic::motion_blur_quality_reduct = graphic_node.get_bool("motion_blur_quality_reduct", graphic::motion_blur_quality_reduct);
   graphic::max_motion_blur_quality_reduct = graphic_node.get_real("max_motion_blur_quality_reduct", graphic::max_motion_blur_quality_reduct);
   graphic::start_focused = graphic_node.get_bool("start_focused", graphic::start_focused);
@@ -124,6 +129,7 @@ void load_config() {
   graphic::set_disable_frame_limit( sync_node.get_bool("disable_frame_limit", graphic::get_disable_frame_limit()) );
   graphic::set_target_fps( sync_node.get_int("target_fps", graphic::get_target_fps()) );
   graphic::cpu_safe = sync_node.get_bool("cpu_safe", graphic::cpu_safe);
+  graphic::render_thread = sync_node.get_bool("render_thread", graphic::render_thread);
   graphic::autoopt_timeout_max = sync_node.get_real("autoopt_timeout_max", graphic::autoopt_timeout_max);
 
   if (hpw::rebind_key_by_scancode) {
@@ -1,4 +1,6 @@
+#include <omp.h>
 #include <ranges>
+#include <exception>
 #include <ctime>
 #include <algorithm>
 #include <unordered_map>
@@ -35,11 +37,13 @@
 #include "graphic/image/image.hpp"
 #include "graphic/animation/animation-manager.hpp"
 #include "graphic/animation/anim-io.hpp"
+#include "graphic/animation/anim-bundle.hpp"
 #include "graphic/animation/anim.hpp"
 #include "graphic/animation/frame.hpp"
 
 void load_resources() {
   detailed_log("loading resources...\n");
+  [[maybe_unused]] cauto start_time = omp_get_wtime();
   init_store_sprite();
 #ifdef EDITOR
   auto names = all_names_in_dir(hpw::cur_dir);
@@ -63,27 +67,63 @@ void load_resources() {
   Strs image_names;
   to_vector(image_names, names | std::views::filter(name_filter));
   iferror (image_names.empty(), "image_names пуст, возможно нет ресурсов в папках");
-  // загрузка в хранилище
-  for (auto &name: image_names) {
-    auto spr {new_shared<Sprite>()};
+  /* чтение из архива и декодирование идут параллельно.
+  Ошибки ловятся внутри потоков: исключение из omp-цикла не выходит */
+  Vector<Shared<Sprite>> sprites(image_names.size());
+  Vector<std::exception_ptr> errors(image_names.size());
+  #pragma omp parallel for schedule(dynamic)
+  cfor (i, image_names.size()) {
+    try {
+      auto& name = image_names[i];
+      auto spr {new_shared<Sprite>()};
 #ifdef EDITOR
-    load(*spr, name);
-    delete_all(name, hpw::cur_dir);
-    conv_sep_for_archive(name);
+      load(*spr, name);
+      delete_all(name, hpw::cur_dir);
+      conv_sep_for_archive(name);
 #else
-    load(hpw::archive->get_file(name), *spr);
+      // несжатый png/webp декодируется прямо из памяти архива
+      Bytes buf;
+      load(*spr, hpw::archive->get_view(name, buf), name);
 #endif
-    hpw::store_sprite->push(name, spr);
+      spr->update_spans();
+      sprites[i] = std::move(spr);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  }
+
+  // загрузка в хранилище в исходном порядке
+  cfor (i, image_names.size()) {
+    if (errors[i])
+      std::rethrow_exception(errors[i]);
+    hpw::store_sprite->push(image_names[i], sprites[i]);
   }
+  hpw_log("loaded " << image_names.size() << " sprites in "
+    << n2s(omp_get_wtime() - start_time, 3) << " sec.\n");
 } // load_resources
 
 void load_animations() {
   init_anim_mgr();
   Shared<Yaml> anim_yml;
 #ifdef EDITOR
+  // редактор сохраняет анимации в yml, поэтому пакет ему не нужен
   anim_yml = new_shared<Yaml>(hpw::cur_dir + "config/animation.yml");
 #else
-  anim_yml = new_shared<Yaml>(hpw::archive->get_file("config/animation.yml"));
+  Bytes yml_buf;
+  cauto anim_yml_mem = hpw::archive->get_view("config/animation.yml", yml_buf);
+  // готовый пакет берётся, только если он собран из этого же animation.yml
+  if (hpw::archive->has_file("config/animation.bin")) {
+    Bytes buf;
+    cauto mem = hpw::archive->get_view("config/animation.bin", buf);
+    anim_bundle::Bundle bundle;
+    if (anim_bundle::load(mem, bundle) &&
+    bundle.source_hash == anim_bundle::source_hash(anim_yml_mem)) {
+      read_anims(bundle);
+      return;
+    }
+    hpw_log("config/animation.bin устарел, анимации грузятся из animation.yml\n");
+  }
+  anim_yml = new_shared<Yaml>(anim_yml_mem, "config/animation.yml");
 #endif
   read_anims(*anim_yml);
 } // load_animations
@@ -142,7 +182,7 @@ Sprite extract_contour(CN<Sprite> src) {
 
     #define set_white(x0, y0) if (ext_mask(x0, y0) == Pal8::mask_invisible) { \
       ret.get_image()->fast_set(x0, y0, Pal8::white, {}); \
-      ret.get_mask()->fast_set(x0, y0, Pal8::mask_visible, {}); \
+      ret.edit_mask()->fast_set(x0, y0, Pal8::mask_visible, {}); \
     }
     set_white(x+1, y+0);
     set_white(x-1, y+0);
@@ -151,6 +191,7 @@ Sprite extract_contour(CN<Sprite> src) {
     #undef set_white
   } // for x/y
 
+  ret.update_spans();
   ret.set_generated(true);
   ret.set_path(src.get_path() + ".extended");
   return ret;
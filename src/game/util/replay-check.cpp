@@ -1,10 +1,12 @@
-#ifdef STABLE_REPLAY
+#include <bit>
 #include <cassert>
+#include <type_traits>
 #include <iostream>
 #include "replay-check.hpp"
 #include "game/core/core.hpp"
 #include "game/core/entities.hpp"
 #include "game/util/keybits.hpp"
+#include "game/util/score-table.hpp"
 #include "game/entity/entity-manager.hpp"
 #include "game/entity/entity-type.hpp"
 #include "game/entity/player.hpp"
@@ -13,6 +15,98 @@
 #include "util/math/vec-util.hpp"
 #include "util/math/random.hpp"
 
+/** FNV-1a. Каждое поле идёт как 64-битное целое побайтно от младшего,
+поэтому хэш не зависит от размеров типов, порядка байт и компилятора */
+class State_hasher final {
+  std::uint64_t m_val {0xcbf29ce484222325ull};
+
+  inline void add_u64(const std::uint64_t val) {
+    cfor (i, sizeof(val)) {
+      m_val ^= (val >> (i * 8u)) & 0xFFu;
+      m_val *= 0x100000001b3ull;
+    }
+  }
+
+public:
+  template <class T> requires std::is_integral_v<T>
+  inline void add(const T val) {
+    if constexpr (std::is_signed_v<T>)
+      add_u64(std::uint64_t(std::int64_t(val)));
+    else
+      add_u64(std::uint64_t(val));
+  }
+
+  template <class T> requires std::is_floating_point_v<T>
+  inline void add(const T val) {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8);
+    if constexpr (sizeof(T) == 4)
+      add(std::bit_cast<std::uint32_t>(val));
+    else
+      add(std::bit_cast<std::uint64_t>(val));
+  }
+
+  inline void add(CN<Str> val) {
+    add(val.size());
+    for (const char ch: val)
+      add(std::uint8_t(ch));
+  }
+
+  inline void add(const Vec val) {
+    add(val.x);
+    add(val.y);
+  }
+
+  inline void add(CN<Phys> phys) {
+    add(phys.get_pos());
+    add(phys.get_vel());
+    add(phys.get_accel());
+    add(phys.get_speed());
+    add(phys.get_deg());
+    add(phys.get_force());
+  }
+
+  inline std::uint64_t get() const { return m_val; }
+}; // State_hasher
+
+std::uint64_t game_state_hash() {
+  State_hasher hash;
+  hash.add(hpw::game_updates_safe);
+  hash.add(rnd_state_hash());
+  hash.add(hpw::get_score());
+  return_if ( !hpw::entity_mgr, hash.get());
+
+  cauto player = hpw::entity_mgr->get_player();
+  for (cnauto entity: hpw::entity_mgr->get_entities()) {
+    assert(entity);
+    // мёртвые объекты лежат в пуле для переиспользования
+    cont_if ( !entity->status.live);
+
+    hash.add(entity->uid);
+    // Entity_type - typeid().hash_code(), он разный у разных компиляторов
+    if (entity->proto != ENTITY_PROTO_NONE)
+      hash.add(hpw::entity_mgr->get_proto_name(entity->proto));
+    else
+      hash.add(entity->proto);
+    hash.add(entity->rnd.get_state());
+    hash.add(entity->status.killed);
+    hash.add(entity->status.collided);
+    hash.add(entity->phys);
+    if (entity->status.collidable) {
+      cauto collidable = dcast<Collidable*>(entity.get());
+      assert(collidable);
+      hash.add(collidable->get_dmg());
+      hash.add(collidable->get_hp());
+    }
+  }
+
+  if (player) {
+    hash.add(player->energy);
+    hash.add(player->m_fuel);
+  }
+  return hash.get();
+} // game_state_hash
+
+#ifdef STABLE_REPLAY
 uint chunk_id {0};
 
 void phys_log(const Phys& phys) {
@@ -1,4 +1,10 @@
 #pragma once
+#include <cstdint>
+
+/** хэш состояния игры: стабильный рандом, сущности, игрок и очки.
+По нему проверяется, что реплей проигрывается так же, как записывался */
+std::uint64_t game_state_hash();
+
 #ifdef STABLE_REPLAY
 
 /// проверяет синхронизацию реплея
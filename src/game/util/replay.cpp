@@ -3,7 +3,11 @@
 #include <fstream>
 #include <sstream>
 #include <cstring>
+#include <iterator>
+#include <algorithm>
 #include <unordered_set>
+#define MINIZ_HEADER_FILE_ONLY // реализация miniz собирается в zip.c
+#include <zip/miniz.h>
 #include "replay.hpp"
 #include "game/util/version.hpp"
 #include "game/util/keybits.hpp"
@@ -22,21 +26,15 @@
 #include "util/log.hpp"
 #include "util/platform.hpp"
 
-#ifdef ECOMEM
-using Stream = std::fstream;
-#else
-struct Stream {
+/// поток в памяти, в нём собираются заголовок и блоки реплея
+struct Mem_stream {
   Vector<char> data {};
   std::size_t pos {};
 
-  inline Stream() {
-    data.reserve(1024 * 100); // обычно столько весит реплей
-  }
-
   inline void write(CP<char> in, const std::size_t sz) {
     assert(sz > 0);
     assert(in != nullptr);
-    data.resize(data.size() + sz);
+    data.resize(std::max(data.size(), pos + sz));
     assert(data.data() != nullptr);
     std::memcpy(data.data() + pos, in, sz);
     pos += sz;
@@ -51,9 +49,26 @@ struct Stream {
   }
 
   inline void set_pos(std::size_t new_pos) { pos = new_pos; }
-
   inline bool eof() const { return pos >= data.size(); }
+  /// сбросить данные без освобождения памяти
+  inline void clear() { data.clear(); pos = 0; }
 };
+
+inline std::size_t stream_left(CN<Mem_stream> file) { return file.data.size() - file.pos; }
+
+#ifdef ECOMEM
+using Stream = std::fstream;
+
+inline std::size_t stream_left(Stream& file) {
+  cauto cur = file.tellg();
+  file.seekg(0, std::ios_base::end);
+  cauto end = file.tellg();
+  file.seekg(cur);
+  return_if (cur < 0 || end < cur, 0);
+  return scast<std::size_t>(end - cur);
+}
+#else
+using Stream = Mem_stream;
 #endif
 
 enum class Platform: byte {
@@ -88,7 +103,8 @@ inline Bits get_bits() {
   return Bits::error;
 }
 
-inline void write_str(Stream& file, CN<Str> str) {
+template <class S>
+void write_str(S& file, CN<Str> str) {
   const uint32_t sz = str.size();
   assert(sz < 1'000);
   file.write(cptr2ptr<CP<char>>(&sz), sizeof(sz));
@@ -96,15 +112,8 @@ inline void write_str(Stream& file, CN<Str> str) {
     file.write(cptr2ptr<CP<char>>(str.data()), sz * sizeof(Str::value_type));
 }
 
-inline void write_key_packet(Stream& file, CN<Key_packet> key_packet) {
-  const uint32_t sz = key_packet.size();
-  assert(sz < 1'000);
-  file.write(cptr2ptr<CP<char>>(&sz), sizeof(sz));
-  if (sz > 0)
-    file.write(cptr2ptr<CP<char>>(key_packet.data()), sz * sizeof(Key_packet::value_type));
-}
-
-inline Str read_str(Stream& file) {
+template <class S>
+Str read_str(S& file) {
   uint32_t sz {0};
   file.read(ptr2ptr<char*>(&sz), sizeof(sz));
   assert(sz < 1'000);
@@ -115,95 +124,247 @@ inline Str read_str(Stream& file) {
   return Str(data.begin(), data.end());
 }
 
-inline Key_packet read_key_packet(Stream& file) {
-  uint32_t sz {};
-  file.read(ptr2ptr<char*>(&sz), sizeof(sz));
+/** чтение пакета клавиш старых версий (v3.x)
+@param sz число клавиш, уже прочитанное из файла */
+template <class S>
+void read_key_packet(S& file, const uint32_t sz, Key_packet& dst) {
   assert(sz < 1'000);
-  return_if (sz == 0, {});
-
-  Key_packet ret(sz);
-  file.read(ptr2ptr<char*>(ret.data()), sz * sizeof(Key_packet::value_type));
-  return ret;
+  dst.resize(sz);
+  if (sz > 0)
+    file.read(ptr2ptr<char*>(dst.data()), sz * sizeof(Key_packet::value_type));
 }
 
-template <typename T>
-T read_data(Stream& file) {
+template <typename T, class S>
+T read_data(S& file) {
   static_assert(sizeof(T) > 0);
-  T ret;
+  T ret {}; // если чтение не удалось (конец fstream), будет 0
   file.read(ptr2ptr<char*>(&ret), sizeof(T));
   return ret;
 }
 
-template <typename T>
-void write_data(Stream& file, const T& data) {
+template <typename T, class S>
+void write_data(S& file, const T& data) {
   static_assert(sizeof(T) > 0);
   file.write(cptr2ptr<CP<char>>(&data), sizeof(T));
 }
 
-template <typename T>
-void write_data(Stream& file, const T&& data) {
-  static_assert(sizeof(T) > 0);
-  file.write(cptr2ptr<CP<char>>(&data), sizeof(T));
+/// LEB128: по 7 бит на байт, старший бит - продолжение
+inline void write_varint(Mem_stream& file, uint32_t val) {
+  while (val >= 0x80u) {
+    write_data(file, scast<byte>(val | 0x80u));
+    val >>= 7;
+  }
+  write_data(file, scast<byte>(val));
+}
+
+inline uint32_t read_varint(Mem_stream& file) {
+  uint32_t ret {};
+  for (uint shift = 0; shift < 32; shift += 7) {
+    cauto b = read_data<byte>(file);
+    ret |= scast<uint32_t>(b & 0x7Fu) << shift;
+    return_if ((b & 0x80u) == 0, ret);
+  }
+  error("слишком длинное число в реплее");
+  return ret;
+}
+
+/// v3.x: вместо числа клавиш в пакете, значит дальше идёт Replay::Checkpoint
+constexpr uint32_t CHECKPOINT_MARK = 0xFFFF'FFFFu;
+
+/** v4: клавиши, которые пишутся в реплей.
+Индекс в массиве - номер бита в Key_bits, порядок не менять */
+constexpr hpw::keycode REPLAY_KEYS[] {
+  hpw::keycode::up,
+  hpw::keycode::down,
+  hpw::keycode::left,
+  hpw::keycode::right,
+  hpw::keycode::enable,
+  hpw::keycode::focus,
+  hpw::keycode::mode,
+  hpw::keycode::bomb,
+  hpw::keycode::shoot,
+};
+using Key_bits = std::uint16_t;
+static_assert(std::size(REPLAY_KEYS) <= sizeof(Key_bits) * 8);
+
+inline Key_bits to_key_bits(CN<Key_packet> key_packet) {
+  Key_bits ret {};
+  for (cauto key: key_packet) {
+    cfor (i, std::size(REPLAY_KEYS)) {
+      if (REPLAY_KEYS[i] == key) {
+        ret |= 1u << i;
+        break;
+      }
+    }
+  }
+  return ret;
 }
 
+inline void from_key_bits(const Key_bits bits, Key_packet& dst) {
+  dst.clear();
+  cfor (i, std::size(REPLAY_KEYS))
+    if (bits & (1u << i))
+      dst.push_back(REPLAY_KEYS[i]);
+}
+
+/** v4: записи внутри блока.
+varint(len << 1), Key_bits - клавиши не менялись len апдейтов подряд;
+varint(1), tick, state_hash - контрольная точка рассинхрона */
+constexpr uint32_t CHECKPOINT_TAG = 1;
+/// после стольких байт блок сбрасывается на диск
+constexpr std::size_t BLOCK_SIZE = 1024 * 16;
+/// больше этого блок считается повреждённым
+constexpr uint32_t MAX_BLOCK_SIZE = 1024 * 1024;
+/// самая длинная серия, чтобы len << 1 влезло в uint32
+constexpr uint32_t MAX_RUN = 0x7FFF'FFFFu;
+
 struct Replay::Impl {
-  Str m_ver {"v3.2"};
+  /** v4.0: заголовок с размером, потом блоки [raw size][stored size][данные].
+  Если stored size == raw size, то блок не сжат, иначе сжат deflate */
+  inline static const Str VER {"v4.0"};
+  /// старые версии (пакеты клавиш на каждый апдейт), тоже читаются
+  inline static const Str VER_V3 {"v3.3"};
+  inline static const Str VER_NO_CHECKPOINTS {"v3.2"};
+  /// больше этого заголовок считается повреждённым
+  constx uint32_t MAX_HEADER_SIZE = 1024 * 64;
   Str m_path {};
-  Stream m_file {};
+  Stream m_file {}; /// для чтения
+  std::ofstream m_out {}; /// для записи, пишется по блокам
   bool m_write_mode {};
+  bool m_old_format {}; /// читается реплей v3.x
+  bool m_closed {};
   Info m_info {};
-  bool m_nosave {false};
+  std::optional<Checkpoint> m_checkpoint {};
+  Mem_stream m_block {}; /// текущий блок записей
+  Vector<char> m_packed {}; /// буффер сжатого блока
+  Key_bits m_run_keys {}; /// клавиши текущей серии
+  uint32_t m_run_len {}; /// сколько апдейтов подряд держатся m_run_keys
 
   inline ~Impl() { close(); }
 
-  inline Impl(CN<Str> path, const bool write_mode, const bool nosave=false)
+  inline Impl(CN<Str> path, const bool write_mode)
   : m_path { path }
   , m_write_mode { write_mode }
-  , m_nosave { nosave }
   {
     conv_sep(m_path);
-    #ifdef ECOMEM
-    m_file.open(m_path, std::ios_base::binary |
-      (write_mode ? std::ios_base::out : std::ios_base::in) );
-    #endif
+    m_block.data.reserve(BLOCK_SIZE * 2);
+    m_packed.reserve(BLOCK_SIZE * 2);
 
-    if (write_mode)
+    if (write_mode) {
+      m_out.open(m_path, std::ios_base::binary | std::ios_base::out);
+      iferror(!m_out, "не удалось открыть реплей для записи по пути \""
+        << m_path << "\"");
       write_header();
-    else
+    } else {
+      #ifdef ECOMEM
+      m_file.open(m_path, std::ios_base::binary | std::ios_base::in);
+      #endif
       read_header();
+    }
   } // c-tor
 
-  /// запись заголовка
+  /// запись заголовка. Он пишется с размером, чтобы его можно было прочитать отдельно
   inline void write_header() {
-    // версия реплея
-    write_str(m_file, m_ver);
+    Mem_stream header;
     // версия игры
-    write_str(m_file, cstr_to_cxxstr(get_game_version()));
+    write_str(header, cstr_to_cxxstr(get_game_version()));
     // платформа
-    write_data(m_file, get_platform());
-    write_data(m_file, get_bits());
+    write_data(header, get_platform());
+    write_data(header, get_bits());
     // SHA256
-    write_str(m_file, hpw::exe_sha256);
-    write_str(m_file, hpw::data_sha256);
+    write_str(header, hpw::exe_sha256);
+    write_str(header, hpw::data_sha256);
     // UPS
     const uint32_t target_ups = hpw::target_ups;
-    write_data(m_file, target_ups);
+    write_data(header, target_ups);
     // сид рандома
     const uint32_t seed = get_rnd_seed();
-    write_data(m_file, seed);
+    write_data(header, seed);
     // имя игрока
-    write_str(m_file, sconv<Str>(hpw::player_name));
+    write_str(header, sconv<Str>(hpw::player_name));
     // уровень сложности
-    write_data(m_file, hpw::difficulty);
+    write_data(header, hpw::difficulty);
     // рекорд
-    write_data(m_file, hpw::get_score());
+    write_data(header, hpw::get_score());
     // дата
-    write_str(m_file, get_data_str());
+    write_str(header, get_data_str());
     // начальный уровень туториал?
-    write_data(m_file, hpw::first_level_is_tutorial);
+    write_data(header, hpw::first_level_is_tutorial);
+
+    // версия реплея
+    write_str(m_out, VER);
+    const uint32_t header_sz = header.data.size();
+    write_data(m_out, header_sz);
+    m_out.write(header.data.data(), header_sz);
+    m_out.flush();
   } // write_header
 
-  /// чтение заголовка
+  /// всё, что лежит в заголовке реплея
+  struct Header {
+    bool old_format {}; /// реплей v3.x
+    Str game_ver {};
+    Platform platform {};
+    Bits bits {};
+    Str exe_sha256 {};
+    Str data_sha256 {};
+    uint32_t target_ups {};
+    uint32_t seed {};
+    Info info {};
+  };
+
+  /** разбор заголовка без побочных эффектов.
+  В v4 заголовок читается по известному размеру, дальше файл не трогается */
+  template <class S>
+  inline static Header read_header_data(S& file, CN<Str> path) {
+    Header ret;
+    // версия реплея
+    auto ver = read_str(file);
+    ret.old_format = ver == VER_V3 || ver == VER_NO_CHECKPOINTS;
+    iferror(ver != VER && !ret.old_format, "версия реплея несовместима с игрой");
+    if (ret.old_format) {
+      read_header_fields(file, ret);
+    } else {
+      cauto header_sz = read_data<uint32_t>(file);
+      iferror(header_sz == 0 || header_sz > MAX_HEADER_SIZE,
+        "неправильный размер заголовка реплея \"" << path << "\"");
+      Mem_stream header;
+      header.data.resize(header_sz);
+      file.read(header.data.data(), header_sz);
+      read_header_fields(header, ret);
+    }
+    ret.info.path = path;
+    ret.info.old_rng = ret.old_format;
+    return ret;
+  } // read_header_data
+
+  template <class S>
+  inline static void read_header_fields(S& file, Header& dst) {
+    // версия игры
+    dst.game_ver = read_str(file);
+    // платформа
+    dst.platform = read_data<Platform>(file);
+    dst.bits = read_data<Bits>(file);
+    // SHA256
+    dst.exe_sha256 = read_str(file);
+    dst.data_sha256 = read_str(file);
+    // UPS
+    dst.target_ups = read_data<uint32_t>(file);
+    // сид рандома
+    dst.seed = read_data<uint32_t>(file);
+    // имя игрока
+    dst.info.player_name = sconv<utf32>( read_str(file) );
+    // уровень сложности
+    dst.info.difficulty = read_data<Difficulty>(file);
+    // рекорд
+    dst.info.score = read_data<int64_t>(file);
+    // дата
+    dst.info.date_str = read_str(file);
+    dst.info.date = to_date(dst.info.date_str);
+    // начальный уровень - туториал?
+    dst.info.first_level_is_tutorial = read_data<decltype(dst.info.first_level_is_tutorial)>(file);
+  } // read_header_fields
+
+  /// чтение заголовка перед проигрыванием
   inline void read_header() {
     #ifndef ECOMEM
     {
@@ -214,69 +375,46 @@ struct Replay::Impl {
     }
     #endif
 
-    // версия реплея
-    auto ver = read_str(m_file);
-    iferror(ver != m_ver, "версия реплея несовместима с игрой");
+    cauto header = read_header_data(m_file, m_path);
+    m_old_format = header.old_format;
+    if (m_old_format)
+      hpw_log("реплей v3.x записан со старым рандомом объектов, игра разойдётся с записью\n");
     // версия игры
     auto cur_game_ver = cstr_to_cxxstr(get_game_version());
-    auto rep_game_ver = read_str(m_file);
-    if (cur_game_ver != rep_game_ver) {
+    if (cur_game_ver != header.game_ver) {
       // TODO показывать окно с ворнингом
       hpw_log("версия реплея не совпадает с версией игры\n");
       hpw_log("  текущая версия игры: " << cur_game_ver << '\n');
-      hpw_log("  версия игры в реплее: " << rep_game_ver << '\n');
+      hpw_log("  версия игры в реплее: " << header.game_ver << '\n');
       hpw_log("  файл реплея: \"" << m_path << "\"\n");
     }
     // платформа
-    cauto platform = read_data<Platform>(m_file);
-    cauto bits = read_data<Bits>(m_file);
-    if (bits != get_bits()) {
+    if (header.bits != get_bits()) {
       hpw_log("реплей записан на системе с разрядностью отличающейся от вашей\n");
       // TODO окно с предупреждением
     }
-    if (platform != get_platform()) {
+    if (header.platform != get_platform()) {
       hpw_log("реплей записан на системе отличающейся от вашей\n");
       // TODO окно с предупреждением
     }
     // SHA256
-    auto exe_sha256 = read_str(m_file);
-    auto data_sha256 = read_str(m_file);
-    if (exe_sha256 != hpw::exe_sha256
-    || data_sha256 != hpw::data_sha256) {
+    if (header.exe_sha256 != hpw::exe_sha256
+    || header.data_sha256 != hpw::data_sha256) {
       hpw_log("чексуммы в реплее не совпадают\n");
       hpw_log("SHA256 EXE игры: " << hpw::exe_sha256 << '\n');
-      hpw_log("SHA256 EXE реплея: " << exe_sha256 << '\n');
+      hpw_log("SHA256 EXE реплея: " << header.exe_sha256 << '\n');
       hpw_log("SHA256 DATA игры: " << hpw::data_sha256 << '\n');
-      hpw_log("SHA256 DATA реплея: " << data_sha256 << '\n');
+      hpw_log("SHA256 DATA реплея: " << header.data_sha256 << '\n');
       // TODO вызов окна с надписью
     }
     // UPS
-    cauto target_ups = read_data<uint32_t>(m_file);
-    iferror(target_ups != scast<uint32_t>(hpw::target_ups),
+    iferror(header.target_ups != scast<uint32_t>(hpw::target_ups),
       "UPS реплея не совпали с игрой");
-    (void)target_ups; // чтоб небыло ворнинга при релизе
-    // сид рандома
-    cauto seed = read_data<uint32_t>(m_file);
-    set_rnd_seed(seed);
-    // имя игрока
-    cauto player_name = sconv<utf32>( read_str(m_file) );
-    // уровень сложности
-    cauto difficulty = read_data<Difficulty>(m_file);
-    hpw::difficulty = difficulty;
-    // рекорд
-    cauto score = read_data<int64_t>(m_file);
-    // дата
-    cauto date = read_str(m_file);
-    // начальный уровень - туториал?
-    hpw::first_level_is_tutorial = read_data<decltype(hpw::first_level_is_tutorial)>(m_file);
-
-    m_info.path = m_path;
-    m_info.date_str = date;
-    m_info.date = to_date(date);
-    m_info.first_level_is_tutorial = hpw::first_level_is_tutorial;
-    m_info.difficulty = difficulty;
-    m_info.score = score;
-    m_info.player_name = player_name;
+
+    set_rnd_seed(header.seed);
+    hpw::difficulty = header.info.difficulty;
+    hpw::first_level_is_tutorial = header.info.first_level_is_tutorial;
+    m_info = header.info;
   } // read_header
 
   inline Str get_data_str() const {
@@ -292,35 +430,161 @@ struct Replay::Impl {
     return ss.str();
   }
 
+  /// читает только заголовок, игровые настройки не меняются
   inline static Info get_info(CN<Str> path) {
-    Impl replay(path, false, true);
-    return replay.m_info;
+    Str fname = path;
+    conv_sep(fname);
+    std::ifstream file(fname, std::ios_base::binary);
+    iferror(!file, "не удалось открыть реплей \"" << fname << "\"");
+    return read_header_data(file, fname).info;
   }
 
   inline void close() {
-    #ifdef ECOMEM
-      m_file.close();
-    #else
-      return_if(m_nosave); // не сейвить в файл
-
-      // запись с буффера на диск
-      std::ofstream file(m_path, std::ios_base::binary);
-      iferror(!file || file.bad(), "не удалось записать реплей по пути \""
-        << m_path << "\"");
-      file.write(m_file.data.data(), m_file.data.size());
-    #endif
+    return_if (!m_write_mode || m_closed);
+    m_closed = true;
+    write_run();
+    flush_block();
+    m_out.close();
   }
 
   inline void push(CN<Key_packet> key_packet) {
     assert(m_write_mode);
-    write_key_packet(m_file, key_packet);
+    cauto keys = to_key_bits(key_packet);
+    if (m_run_len != 0 && keys == m_run_keys && m_run_len < MAX_RUN) {
+      ++m_run_len;
+      return;
+    }
+    write_run();
+    m_run_keys = keys;
+    m_run_len = 1;
   }
 
-  inline std::optional<Key_packet> pop() {
+  inline void push_checkpoint(CN<Checkpoint> checkpoint) {
+    assert(m_write_mode);
+    // серия до контрольной точки должна прочитаться раньше неё
+    write_run();
+    write_varint(m_block, CHECKPOINT_TAG);
+    write_data(m_block, checkpoint.tick);
+    write_data(m_block, checkpoint.state_hash);
+    // после контрольной точки всё сразу на диск, чтобы при вылете игры реплей не пропал
+    flush_block();
+  }
+
+  /// дописать текущую серию клавиш в блок
+  inline void write_run() {
+    return_if (m_run_len == 0);
+    write_varint(m_block, m_run_len << 1);
+    write_data(m_block, m_run_keys);
+    m_run_len = 0;
+    if (m_block.data.size() >= BLOCK_SIZE)
+      flush_block();
+  }
+
+  /// сжать блок, если получится, и записать на диск
+  inline void flush_block() {
+    return_if (m_block.data.empty());
+    const uint32_t raw_sz = m_block.data.size();
+    uint32_t stored_sz = raw_sz;
+    CP<char> stored = m_block.data.data();
+
+    if (hpw::compress_replay) {
+      m_packed.resize(raw_sz);
+      // в буффер меньше исходного, иначе сжатие бессмысленно
+      cauto packed_sz = tdefl_compress_mem_to_mem(m_packed.data(), raw_sz - 1,
+        m_block.data.data(), raw_sz, TDEFL_DEFAULT_MAX_PROBES);
+      if (packed_sz != 0 && packed_sz < raw_sz) {
+        stored_sz = packed_sz;
+        stored = m_packed.data();
+      }
+    }
+
+    write_data(m_out, raw_sz);
+    write_data(m_out, stored_sz);
+    m_out.write(stored, stored_sz);
+    m_out.flush();
+    if ( !m_out)
+      hpw_log("не удалось записать реплей по пути \"" << m_path << "\"\n");
+    m_block.clear();
+  } // flush_block
+
+  /** прочитать следующий блок с диска
+  @return false, если блоков больше нет или последний блок недописан */
+  inline bool load_block() {
+    return_if (stream_left(m_file) < sizeof(uint32_t) * 2, false);
+    cauto raw_sz = read_data<uint32_t>(m_file);
+    cauto stored_sz = read_data<uint32_t>(m_file);
+    iferror(raw_sz == 0 || raw_sz > MAX_BLOCK_SIZE || stored_sz == 0 || stored_sz > raw_sz,
+      "повреждённый блок в реплее \"" << m_path << "\"");
+    if (stream_left(m_file) < stored_sz) {
+      // игра закрылась во время записи блока
+      hpw_log("реплей \"" << m_path << "\" обрывается на недописанном блоке\n");
+      return false;
+    }
+
+    m_block.clear();
+    m_block.data.resize(raw_sz);
+    if (stored_sz == raw_sz) {
+      m_file.read(m_block.data.data(), raw_sz);
+    } else {
+      m_packed.resize(stored_sz);
+      m_file.read(m_packed.data(), stored_sz);
+      cauto sz = tinfl_decompress_mem_to_mem(m_block.data.data(), raw_sz,
+        m_packed.data(), stored_sz, 0);
+      iferror(sz != raw_sz, "не удалось распаковать блок реплея \"" << m_path << "\"");
+    }
+    return true;
+  } // load_block
+
+  inline bool pop(Key_packet& dst) {
     assert(!m_write_mode);
-    if (m_file.eof())
-      return {};
-    return read_key_packet(m_file);
+    return_if (m_old_format, pop_old(dst));
+
+    while (m_run_len == 0) {
+      if (m_block.eof()) {
+        return_if (!load_block(), false);
+        continue;
+      }
+
+      cauto tag = read_varint(m_block);
+      if (tag == CHECKPOINT_TAG) {
+        Checkpoint checkpoint;
+        checkpoint.tick = read_data<decltype(checkpoint.tick)>(m_block);
+        checkpoint.state_hash = read_data<decltype(checkpoint.state_hash)>(m_block);
+        m_checkpoint = checkpoint;
+        continue;
+      }
+
+      m_run_len = tag >> 1;
+      iferror(m_run_len == 0, "пустая серия клавиш в реплее \"" << m_path << "\"");
+      m_run_keys = read_data<Key_bits>(m_block);
+    }
+
+    --m_run_len;
+    from_key_bits(m_run_keys, dst);
+    return true;
+  } // pop
+
+  /// чтение v3.x: число клавиш и клавиши на каждый апдейт
+  inline bool pop_old(Key_packet& dst) {
+    while ( !m_file.eof()) {
+      cauto sz = read_data<uint32_t>(m_file);
+      if (sz != CHECKPOINT_MARK) {
+        read_key_packet(m_file, sz, dst);
+        return true;
+      }
+
+      Checkpoint checkpoint;
+      checkpoint.tick = read_data<decltype(checkpoint.tick)>(m_file);
+      checkpoint.state_hash = read_data<decltype(checkpoint.state_hash)>(m_file);
+      m_checkpoint = checkpoint;
+    }
+    return false;
+  }
+
+  inline std::optional<Checkpoint> pop_checkpoint() {
+    auto ret = m_checkpoint;
+    m_checkpoint = {};
+    return ret;
   }
 
   /// конвертирует дату и время из строки в удобный формат
@@ -357,6 +621,8 @@ Replay::Replay(CN<Str> path, bool write_mode)
 Replay::~Replay() {}
 void Replay::close() { impl->close(); }
 void Replay::push(CN<Key_packet> key_packet) { impl->push(key_packet); }
-std::optional<Key_packet> Replay::pop() { return impl->pop(); }
+bool Replay::pop(Key_packet& dst) { return impl->pop(dst); }
+void Replay::push_checkpoint(CN<Checkpoint> checkpoint) { impl->push_checkpoint(checkpoint); }
+std::optional<Replay::Checkpoint> Replay::pop_checkpoint() { return impl->pop_checkpoint(); }
 CP<Replay::Impl> Replay::get_impl() const { return impl.get(); }
 Replay::Info Replay::get_info(CN<Str> path) { return Impl::get_info(path); }
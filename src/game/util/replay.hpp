@@ -18,13 +18,20 @@ class Replay final {
 
 public:
   struct Info;
+  struct Checkpoint;
 
   explicit Replay(CN<Str> path, bool write_mode);
   ~Replay();
   void close();
   void push(CN<Key_packet> key_packet);
-  std::optional<Key_packet> pop(); /// будет возвращать нажатые клавиши, пока не кончатся
+  /** читает нажатые клавиши следующего апдейта в dst
+  @return false, когда реплей кончился */
+  bool pop(Key_packet& dst);
+  void push_checkpoint(CN<Checkpoint> checkpoint);
+  /// контрольная точка, прочитанная при последнем pop, если она была
+  std::optional<Checkpoint> pop_checkpoint();
   CP<Impl> get_impl() const;
+  /// прочитать только заголовок реплея, без ключей и побочных эффектов
   static Info get_info(CN<Str> path);
 }; // Replay
 
@@ -37,6 +44,13 @@ struct Date {
   uint second {};
 };
 
+/** контрольная точка рассинхрона: хэш состояния игры после апдейта tick.
+Восстановить по ней игру нельзя, только сравнить с живым состоянием */
+struct Replay::Checkpoint {
+  std::uint32_t tick {};
+  std::uint64_t state_hash {}; /// game_state_hash()
+};
+
 struct Replay::Info {
   Date date {};
   utf32 player_name {};
@@ -45,4 +59,7 @@ struct Replay::Info {
   std::int64_t score {};
   Difficulty difficulty {};
   bool first_level_is_tutorial {};
+  /** реплей v3.x записан до потоков рандома у объектов (Entity::rnd).
+  Заголовок читается, но проиграть его без рассинхрона нельзя */
+  bool old_rng {};
 };
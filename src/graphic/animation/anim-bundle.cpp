@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cstring>
+#include "anim-bundle.hpp"
+#include "util/file/yaml.hpp"
+#include "util/error.hpp"
+
+namespace anim_bundle {
+
+constexpr char MAGIC[4] {'H', 'P', 'W', 'A'};
+
+/// заголовок файла пакета
+struct Header {
+  char magic[4] {};
+  std::uint32_t version {};
+  std::uint64_t source_hash {};
+  std::uint32_t anim_count {};
+  std::uint32_t frame_count {};
+  std::uint32_t poly_count {};
+  std::uint32_t point_count {};
+  std::uint32_t strings_size {};
+  std::uint32_t reserved {};
+};
+
+std::uint64_t source_hash(std::span<const byte> yml) {
+  // FNV-1a
+  std::uint64_t ret = 0xcbf29ce484222325ull;
+  for (cauto ch: yml) {
+    ret ^= ch;
+    ret *= 0x100000001b3ull;
+  }
+  return ret;
+}
+
+Bundle compile(CN<Yaml> src, std::uint64_t hash) {
+  Bundle ret;
+  ret.source_hash = hash;
+  auto add_str = [&ret](CN<Str> str) {
+    Str_ref ref {.offset = scast<std::uint32_t>(ret.strings.size()),
+      .size = scast<std::uint32_t>(str.size())};
+    ret.strings += str;
+    return ref;
+  };
+
+  // порядок обхода как в read_anims(Yaml)
+  auto animations_node = src["animations"];
+  auto anim_names = animations_node.root_tags();
+  std::sort(anim_names.begin(), anim_names.end());
+
+  for (cnauto anim_name: anim_names) {
+    auto anim_node = animations_node[anim_name];
+    Anim_rec anim;
+    anim.name = add_str(anim_name);
+
+    // полигоны хитбокса
+    anim.first_poly = ret.polys.size();
+    auto hitbox_node = anim_node["hitbox"];
+    if (hitbox_node.check()) {
+      anim.has_hitbox = 1;
+      auto polygons_node = hitbox_node["polygons"];
+      for (cnauto poly_name: polygons_node.root_tags()) {
+        auto poly_node = polygons_node[poly_name];
+        auto poly_offset_v = poly_node.get_v_real("offset", {0, 0});
+        Poly_rec poly;
+        poly.offset_x = poly_offset_v.at(0);
+        poly.offset_y = poly_offset_v.at(1);
+        poly.first_point = ret.points.size();
+        auto points_node = poly_node["points"];
+        for (cnauto point_name: points_node.root_tags()) {
+          auto point_v = points_node.get_v_real(point_name, {0, 0});
+          ret.points.emplace_back(Point_rec{.x = point_v.at(0), .y = point_v.at(1)});
+        }
+        poly.point_count = ret.points.size() - poly.first_point;
+        ret.polys.emplace_back(poly);
+      }
+    }
+    anim.poly_count = ret.polys.size() - anim.first_poly;
+
+    // кадры
+    anim.first_frame = ret.frames.size();
+    auto frames_node = anim_node["frames"];
+    for (cnauto frame_name: frames_node.root_tags()) {
+      auto cur_frame_node = frames_node[frame_name];
+      Frame_rec frame;
+      frame.duration = cur_frame_node.get_real("duration");
+      frame.directions = cur_frame_node.get_int("directions");
+      frame.ccf = add_str(cur_frame_node.get_str("ccf"));
+      frame.cgp = add_str(cur_frame_node.get_str("cgp"));
+      auto rotate_offset_v = cur_frame_node.get_v_real("rotate offset");
+      if (!rotate_offset_v.empty()) {
+        frame.rotate_offset_x = rotate_offset_v.at(0);
+        frame.rotate_offset_y = rotate_offset_v.at(1);
+      }
+      frame.sprite_path = add_str(cur_frame_node.get_str("sprite path"));
+      auto sprite_offset_v = cur_frame_node.get_v_real("sprite offset");
+      if (!sprite_offset_v.empty()) {
+        frame.sprite_offset_x = sprite_offset_v.at(0);
+        frame.sprite_offset_y = sprite_offset_v.at(1);
+      }
+      ret.frames.emplace_back(frame);
+    }
+    anim.frame_count = ret.frames.size() - anim.first_frame;
+    ret.anims.emplace_back(anim);
+  } // for anim_names
+
+  return ret;
+} // compile
+
+template <class T>
+static void push_array(Bytes& dst, CN<Vector<T>> src) {
+  cauto p = cptr2ptr<CP<byte>>(src.data());
+  dst.insert(dst.end(), p, p + src.size() * sizeof(T));
+}
+
+Bytes save(CN<Bundle> bundle) {
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.source_hash = bundle.source_hash;
+  header.anim_count = bundle.anims.size();
+  header.frame_count = bundle.frames.size();
+  header.poly_count = bundle.polys.size();
+  header.point_count = bundle.points.size();
+  header.strings_size = bundle.strings.size();
+
+  Bytes ret;
+  cauto header_p = cptr2ptr<CP<byte>>(&header);
+  ret.insert(ret.end(), header_p, header_p + sizeof(header));
+  push_array(ret, bundle.anims);
+  push_array(ret, bundle.frames);
+  push_array(ret, bundle.polys);
+  push_array(ret, bundle.points);
+  ret.insert(ret.end(), bundle.strings.begin(), bundle.strings.end());
+  return ret;
+} // save
+
+template <class T>
+static bool pop_array(std::span<const byte> mem, std::size_t& pos,
+std::size_t count, Vector<T>& dst) {
+  cauto bytes = count * sizeof(T);
+  return_if (pos + bytes > mem.size(), false);
+  dst.resize(count);
+  std::memcpy(dst.data(), mem.data() + pos, bytes);
+  pos += bytes;
+  return true;
+}
+
+bool load(std::span<const byte> mem, Bundle& dst) {
+  Header header;
+  return_if (mem.size() < sizeof(header), false);
+  std::memcpy(&header, mem.data(), sizeof(header));
+  return_if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0, false);
+  return_if (header.version != VERSION, false);
+
+  std::size_t pos = sizeof(header);
+  return_if ( !pop_array(mem, pos, header.anim_count, dst.anims), false);
+  return_if ( !pop_array(mem, pos, header.frame_count, dst.frames), false);
+  return_if ( !pop_array(mem, pos, header.poly_count, dst.polys), false);
+  return_if ( !pop_array(mem, pos, header.point_count, dst.points), false);
+  return_if (mem.size() - pos != header.strings_size, false);
+  dst.strings.assign(cptr2ptr<CP<char>>(mem.data() + pos), header.strings_size);
+  dst.source_hash = header.source_hash;
+
+  // ссылки на диапазоны не должны выходить за массивы
+  auto str_ok = [&](const Str_ref ref) { return ref.offset + std::uint64_t(ref.size) <= dst.strings.size(); };
+  for (cnauto anim: dst.anims) {
+    return_if (anim.first_frame + std::uint64_t(anim.frame_count) > dst.frames.size(), false);
+    return_if (anim.first_poly + std::uint64_t(anim.poly_count) > dst.polys.size(), false);
+    return_if ( !str_ok(anim.name), false);
+  }
+  for (cnauto frame: dst.frames)
+    return_if ( !str_ok(frame.sprite_path) || !str_ok(frame.ccf) || !str_ok(frame.cgp), false);
+  for (cnauto poly: dst.polys)
+    return_if (poly.first_point + std::uint64_t(poly.point_count) > dst.points.size(), false);
+  return true;
+} // load
+
+} // anim_bundle ns
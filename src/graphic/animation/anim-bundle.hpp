@@ -0,0 +1,79 @@
+#pragma once
+/** @file бинарный пакет анимаций.
+Собирается тулзой anim-bundle из animation.yml и хранит всё плоскими
+массивами: анимации ссылаются на диапазоны кадров и полигонов хитбокса,
+полигоны на диапазоны точек, строки лежат в одной общей таблице */
+#include <span>
+#include <cstdint>
+#include "util/str.hpp"
+#include "util/file/file.hpp"
+
+class Yaml;
+
+namespace anim_bundle {
+
+/// поменять при любом изменении структур ниже
+constexpr std::uint32_t VERSION = 1;
+
+/// строка из общей таблицы строк
+struct Str_ref {
+  std::uint32_t offset {};
+  std::uint32_t size {};
+};
+
+struct Anim_rec {
+  Str_ref name {};
+  std::uint32_t first_frame {};
+  std::uint32_t frame_count {};
+  std::uint32_t first_poly {};
+  std::uint32_t poly_count {};
+  std::uint32_t has_hitbox {}; /// в yml была нода hitbox
+};
+
+struct Frame_rec {
+  Str_ref sprite_path {};
+  Str_ref ccf {}; /// пустая строка - метод по умолчанию
+  Str_ref cgp {}; /// пустая строка - паттерн по умолчанию
+  real duration {};
+  std::uint32_t directions {};
+  real rotate_offset_x {};
+  real rotate_offset_y {};
+  real sprite_offset_x {};
+  real sprite_offset_y {};
+};
+
+struct Poly_rec {
+  real offset_x {};
+  real offset_y {};
+  std::uint32_t first_point {};
+  std::uint32_t point_count {};
+};
+
+struct Point_rec {
+  real x {};
+  real y {};
+};
+
+/// весь пакет в памяти
+struct Bundle {
+  std::uint64_t source_hash {}; /// хэш animation.yml, из которого собран пакет
+  Vector<Anim_rec> anims {};
+  Vector<Frame_rec> frames {};
+  Vector<Poly_rec> polys {};
+  Vector<Point_rec> points {};
+  Str strings {};
+
+  inline Str get(const Str_ref ref) const { return strings.substr(ref.offset, ref.size); }
+};
+
+/// хэш исходного animation.yml (по нему видно, что пакет устарел)
+std::uint64_t source_hash(std::span<const byte> yml);
+/// собрать пакет из animation.yml
+Bundle compile(CN<Yaml> src, std::uint64_t hash);
+/// сериализовать пакет
+Bytes save(CN<Bundle> bundle);
+/** прочитать пакет из памяти
+* @return false, если данные битые или другой версии */
+bool load(std::span<const byte> mem, Bundle& dst);
+
+} // anim_bundle ns
@@ -4,6 +4,7 @@
 #include <cmath>
 #include <utility>
 #include "anim-io.hpp"
+#include "anim-bundle.hpp"
 #include "anim.hpp"
 #include "frame.hpp"
 #include "util/file/yaml.hpp"
@@ -92,11 +93,11 @@ void read_anims(CN<Yaml> src) {
 
   #pragma omp parallel for schedule(dynamic)
   cfor (i, anim_names.size()) {
+    /* Anim и Frame тут локальные для потока: они только создаются и перемещаются,
+    счётчики ссылок не трогаются. Копии и удаления Shared - только под critical */
     cnauto anim_name {anim_names[i]};
     // анимация будет сохранена в Anim_mgr
-    Shared<Anim> anim;
-    #pragma omp critical (make_anim)
-    { anim = new_shared<Anim>(); }
+    auto anim = new_shared<Anim>();
     auto anim_node = animations_node[anim_name];
 
     // загрузка хитбокса
@@ -131,9 +132,14 @@ void read_anims(CN<Yaml> src) {
       // прочитать источник кадра
       auto sprite_path = cur_frame_node.get_str("sprite path");
       if (!sprite_path.empty()) {
-        auto finded_sprite = hpw::store_sprite->find(sprite_path);
-        if (finded_sprite)
-          frame->source_ctx.direct_0.sprite = finded_sprite;
+        // один спрайт бывает у нескольких анимаций, а Weak однопоточный
+        #pragma omp critical (store_sprite)
+        {
+          ALLOW_SHARED_IN_THREAD
+          cnauto finded_sprite = hpw::store_sprite->find(sprite_path);
+          if (finded_sprite)
+            frame->source_ctx.direct_0.sprite = finded_sprite;
+        }
       }
       // смещение отрисовки относительно центра спрайта
       auto sprite_offset_v = cur_frame_node.get_v_real("sprite offset");
@@ -145,14 +151,86 @@ void read_anims(CN<Yaml> src) {
 
       //#pragma omp critical (reinit_directions_by_source)
       frame->reinit_directions_by_source();
-      anim->add_frame(frame);
+      anim->add_frame(std::move(frame));
     } // for frames_node tags
 
     #pragma omp critical (anim_mgr_add_anim)
-    { hpw::anim_mgr->add_anim(anim_name, anim); }
+    {
+      ALLOW_SHARED_IN_THREAD
+      hpw::anim_mgr->add_anim(anim_name, anim);
+      anim = {}; // своя ссылка отпускается тут же, а не в конце итерации
+    }
   } // root tags
 } // read_anims
 
+void read_anims(CN<anim_bundle::Bundle> src) {
+  detailed_log("read all anims from bundle\n");
+  assert(hpw::entity_mgr);
+
+  // пул хитбоксов не потокобезопасный, поэтому всё берётся заранее
+  Vector<Pool_ptr(Hitbox)> hitboxes(src.anims.size());
+  cfor (i, src.anims.size())
+    if (src.anims[i].has_hitbox)
+      hitboxes[i] = hpw::entity_mgr->get_hitbox_pool().new_object<Hitbox>();
+
+  #pragma omp parallel for schedule(dynamic)
+  cfor (i, src.anims.size()) {
+    // как и в read_anims(Yaml): копии и удаления Shared только под critical
+    cnauto anim_rec = src.anims[i];
+    auto anim = new_shared<Anim>();
+
+    // хитбокс
+    if (anim_rec.has_hitbox) {
+      nauto hitbox_source = hitboxes[i];
+      cfor (poly_idx, anim_rec.poly_count) {
+        cnauto poly_rec = src.polys[anim_rec.first_poly + poly_idx];
+        Polygon loaded_poly;
+        loaded_poly.offset = Vec(poly_rec.offset_x, poly_rec.offset_y);
+        loaded_poly.points.reserve(poly_rec.point_count);
+        cfor (point_idx, poly_rec.point_count) {
+          cnauto point = src.points[poly_rec.first_point + point_idx];
+          loaded_poly.points.emplace_back(Vec(point.x, point.y));
+        }
+        hitbox_source->polygons.emplace_back(std::move(loaded_poly));
+      }
+      if (scast<bool>(*hitbox_source))
+        anim->update_hitbox(hitbox_source);
+    }
+
+    // кадры
+    cfor (frame_idx, anim_rec.frame_count) {
+      cnauto frame_rec = src.frames[anim_rec.first_frame + frame_idx];
+      auto frame = new_shared<Frame>();
+      frame->duration = frame_rec.duration;
+      frame->source_ctx.max_directions = frame_rec.directions;
+      if (frame_rec.ccf.size != 0)
+        frame->source_ctx.ccf = convert_to_ccf(src.get(frame_rec.ccf));
+      if (frame_rec.cgp.size != 0)
+        frame->source_ctx.cgp = convert_to_cgp(src.get(frame_rec.cgp));
+      frame->source_ctx.rotate_offset = Vec(frame_rec.rotate_offset_x, frame_rec.rotate_offset_y);
+      if (frame_rec.sprite_path.size != 0) {
+        #pragma omp critical (store_sprite)
+        {
+          ALLOW_SHARED_IN_THREAD
+          cnauto finded_sprite = hpw::store_sprite->find(src.get(frame_rec.sprite_path));
+          if (finded_sprite)
+            frame->source_ctx.direct_0.sprite = finded_sprite;
+        }
+      }
+      frame->source_ctx.direct_0.offset = Vec(frame_rec.sprite_offset_x, frame_rec.sprite_offset_y);
+      frame->reinit_directions_by_source();
+      anim->add_frame(std::move(frame));
+    }
+
+    #pragma omp critical (anim_mgr_add_anim)
+    {
+      ALLOW_SHARED_IN_THREAD
+      hpw::anim_mgr->add_anim(src.get(anim_rec.name), anim);
+      anim = {};
+    }
+  } // for anims
+} // read_anims (bundle)
+
 void save_anims(Yaml& dst) {
   assert (hpw::anim_mgr);
   hpw_log("save all anims\n");
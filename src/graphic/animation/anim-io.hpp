@@ -2,8 +2,11 @@
 #include "util/macro.hpp"
 
 class Yaml;
+namespace anim_bundle { struct Bundle; }
 
 /// загрузить все анимации в yml файл
 void read_anims(CN<Yaml> src);
+/// загрузить все анимации из бинарного пакета (см. anim-bundle.hpp)
+void read_anims(CN<anim_bundle::Bundle> src);
 /// сохраняет все анимации в yml файл
 void save_anims(Yaml& dst);
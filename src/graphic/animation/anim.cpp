@@ -65,6 +65,7 @@ Anim::Anim()
 {}
 
 void Anim::add_frame(CN<Shared<Frame>> frame) { frames.emplace_back(frame); }
+void Anim::add_frame(Shared<Frame>&& frame) { frames.emplace_back(std::move(frame)); }
 
 void Anim::insert(std::size_t pos, CN<Shared<Frame>> frame) {
   if (frames.empty()) {
@@ -118,16 +119,22 @@ void Anim::update_hitbox(CN<Pool_ptr(Hitbox)> _hitbox, uint _directions) {
   source_hitbox = _hitbox;
 
   // создать все хитбоксы направлений
-  hitbox_diections = new_shared<Hitbox_diections>(_directions);
-  auto max_diections = hitbox_diections->max_diections();
+  auto new_diections = new_shared<Hitbox_diections>(_directions);
+  auto max_diections = new_diections->max_diections();
   auto degree_step = 360.0 / max_diections;
   cfor (i, max_diections) {
     auto degree = i * degree_step;
-    auto& diection = hitbox_diections->get(degree);
+    auto& diection = new_diections->get(degree);
     diection = *source_hitbox; // берём копию с эталона
     diection.rotate(degree); // поворачиваем всё что можно
     diection.simple = cover_polygons(diection.polygons); // внешний покрывающие хитбокс
   }
+  // анимации грузятся в потоках OMP, а старый Shared тут освобождается
+  #pragma omp critical (anim_hitbox)
+  {
+    ALLOW_SHARED_IN_THREAD
+    hitbox_diections = std::move(new_diections);
+  }
 } // update_hitbox
 
 CN<decltype(Anim::source_hitbox)> Anim::get_hitbox_source() const {
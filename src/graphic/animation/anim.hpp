@@ -29,6 +29,8 @@ public:
   Anim* operator =(Anim&& other) = delete;
 
   void add_frame (CN<Shared<Frame>> frame);
+  /// без копии Shared, поэтому можно звать из потока OMP для своей анимации
+  void add_frame (Shared<Frame>&& frame);
   void insert(std::size_t pos, CN<Shared<Frame>> frame);
   void remove_frame (std::size_t frame_num);
   void swap_frame (std::size_t a, std::size_t b);
@@ -8,6 +8,7 @@
 #include "graphic/util/graphic-util.hpp"
 #include "graphic/util/rotation.hpp"
 #include "graphic/util/rotsprite.hpp"
+#include "graphic/animation/rotsprite-cache.hpp"
 #include "graphic/sprite/sprite.hpp"
 #include "util/math/mat.hpp"
 #include "util/math/vec.hpp"
@@ -28,10 +29,33 @@ void Frame::clear_directions() {
   degree_frag = {};
 }
 
+/** положить сгенерированный поворот в хранилище и связать с dst.
+Кадры грузятся в потоках, а Shared/Weak однопоточные, поэтому счётчики ссылок
+трогаются только под critical (store_sprite). Спрайт остаётся доступен через Borrow */
+inline Borrow<Sprite> push_generated(CN<Str> path, Shared<Sprite>&& sprite, Weak<Sprite>& dst) {
+  Borrow<Sprite> ret;
+  #pragma omp critical (store_sprite)
+  {
+    ALLOW_SHARED_IN_THREAD
+    cnauto from_store = hpw::store_sprite->push(path, sprite);
+    dst = from_store;
+    ret = borrow(from_store);
+    sprite = {};
+  }
+  return ret;
+}
+
 void Frame::reinit_directions_by_source() {
   clear_directions();
   return_if (source_ctx.max_directions == 0);
-  if (source_ctx.direct_0.sprite.expired()) {
+  // исходный спрайт бывает общим у кадров разных анимаций
+  Borrow<Sprite> src;
+  #pragma omp critical (store_sprite)
+  {
+    ALLOW_SHARED_IN_THREAD
+    src = borrow(source_ctx.direct_0.sprite);
+  }
+  if ( !src) {
     detailed_log("ctx sprite is empty\n");
     return;
   }
@@ -47,7 +71,7 @@ void Frame::reinit_directions_by_source() {
 
   // для генерации симметричных углов, можно копировать только одну четверть
   if (source_ctx.max_directions % 4 == 0) {
-    init_quarters();
+    init_quarters(*src);
     return;
   }
 
@@ -55,72 +79,72 @@ void Frame::reinit_directions_by_source() {
   cfor (i, source_ctx.max_directions) {
     Direct direct;
     direct.offset = source_ctx.direct_0.offset;
-    auto new_path = source_ctx.direct_0.sprite.lock()->get_path() + "." + n2s(i);
+    auto new_path = src->get_path() + "." + n2s(i);
     auto new_sprite = new_shared<Sprite>(
-      rotate_and_optimize(*source_ctx.direct_0.sprite.lock(), degree_frag * i,
+      cached_rotate_and_optimize(*src, degree_frag * i,
       direct.offset, source_ctx.rotate_offset, source_ctx.cgp, source_ctx.ccf)
     );
+    new_sprite->update_spans();
     new_sprite->set_generated(true);
-    
-    #pragma omp critical (store_sprite)
-    {
-      auto from_store = hpw::store_sprite->push(new_path, new_sprite);
-      direct.sprite = from_store;
-    }
-    directions.emplace_back(direct);
+    push_generated(new_path, std::move(new_sprite), direct.sprite);
+    directions.emplace_back(std::move(direct));
   }
 } // init_directions
 
 void Frame::init_once() {
-  directions.emplace_back(
-    source_ctx.direct_0.sprite,
-    source_ctx.direct_0.offset
-  );
+  #pragma omp critical (store_sprite)
+  {
+    ALLOW_SHARED_IN_THREAD
+    directions.emplace_back(
+      source_ctx.direct_0.sprite,
+      source_ctx.direct_0.offset
+    );
+  }
 }
 
-void Frame::init_quarters() {
+void Frame::init_quarters(CN<Sprite> src) {
   // degree_frag уже задан в init_directions
 // сгенерировать только одну четверть поворотов
   auto max_quarter = source_ctx.max_directions / 4;
+  // спрайты поворотов по индексам directions, чтобы не делать lock
+  Vector<Borrow<Sprite>> generated;
+  generated.reserve(source_ctx.max_directions);
   // I
   cfor (i, max_quarter) {
     Direct direct;
     direct.offset = source_ctx.direct_0.offset;
     auto new_sprite = new_shared<Sprite>(
-      rotate_and_optimize(*source_ctx.direct_0.sprite.lock(), degree_frag * i,
+      cached_rotate_and_optimize(src, degree_frag * i,
         direct.offset, source_ctx.rotate_offset, source_ctx.cgp, source_ctx.ccf)
     );
+    new_sprite->update_spans();
     new_sprite->set_generated(true);
-    auto new_path = source_ctx.direct_0.sprite.lock()->get_path() + "." + n2s(i);
-    #pragma omp critical (store_sprite)
-    {
-      auto from_store = hpw::store_sprite->push(new_path, new_sprite);
-      direct.sprite = from_store;
-    }
+    auto new_path = src.get_path() + "." + n2s(i);
+    generated.emplace_back(push_generated(new_path, std::move(new_sprite), direct.sprite));
     directions.emplace_back(std::move(direct));
   }
 // оставшиеся четверти дополнить
   cfor (quarter, 3) {
     cfor (i, max_quarter) {
       Direct direct;
+      Borrow<Sprite> rotated;
       // берётся разворот с предыдущей четверти
       auto idx = i + max_quarter * quarter;
-      auto src_direction = directions.at(idx);
-      if (!src_direction.sprite.expired()) {
-        auto new_sprite = new_shared<Sprite>(rotate90(*src_direction.sprite.lock()));
+      cnauto src_direction = directions.at(idx);
+      cnauto src_sprite = generated.at(idx);
+      if (src_sprite) {
+        auto new_sprite = new_shared<Sprite>(rotate90(*src_sprite));
+        new_sprite->update_spans();
         new_sprite->set_generated(true);
-        auto new_path = src_direction.sprite.lock()->get_path()
+        auto new_path = src_sprite->get_path()
           + "." + n2s(max_quarter + quarter * i);
-        #pragma omp critical (store_sprite)
-        {
-          auto from_store = hpw::store_sprite->push(new_path, new_sprite);
-          direct.sprite = from_store;
-        }
+        rotated = push_generated(new_path, std::move(new_sprite), direct.sprite);
         direct.offset = rotate_deg({}, src_direction.offset, 90);
         // коррекция повёрнутого оффсета
-        direct.offset.x -= direct.sprite.lock()->X() - 1;
+        direct.offset.x -= rotated->X() - 1;
       }
       directions.emplace_back(std::move(direct));
+      generated.emplace_back(rotated);
     }
   }
 }  // init_quarters
@@ -13,7 +13,7 @@ class Frame final {
   static Str generate_frame_name();
 
   void init_once(); /// анимация с одним разворотом
-  void init_quarters();
+  void init_quarters(CN<Sprite> src);
   void accept_degree_offset(real &degree) const;
 
 public:
@@ -0,0 +1,254 @@
+#include <omp.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include "hash_sha256/hash_sha256.h"
+#include "rotsprite-cache.hpp"
+#include "graphic/sprite/sprite.hpp"
+#include "graphic/image/image.hpp"
+#include "game/core/common.hpp"
+#include "game/core/graphic.hpp"
+#include "game/util/config.hpp"
+#include "util/file/file.hpp"
+#include "util/file/yaml.hpp"
+#include "util/path.hpp"
+#include "util/str-util.hpp"
+#include "util/log.hpp"
+
+/// поменять, если изменится алгоритм поворота или формат файла
+constexpr std::uint32_t ROTSPRITE_CACHE_VERSION = 1;
+/// больше стольких файлов или байт старые файлы кэша удаляются при запуске
+constexpr std::size_t ROTSPRITE_CACHE_MAX_FILES = 20'000;
+constexpr std::uintmax_t ROTSPRITE_CACHE_MAX_SIZE = 256ull * 1024u * 1024u;
+constexpr char ROTSPRITE_CACHE_MAGIC[4] {'H', 'P', 'W', 'R'};
+
+template <class T>
+static void push_pod(Bytes& dst, const T val) {
+  cauto src = cptr2ptr<CP<byte>>(&val);
+  dst.insert(dst.end(), src, src + sizeof(T));
+}
+
+template <class T>
+static bool pop_pod(CN<Bytes> src, std::size_t& pos, T& val) {
+  return_if (pos + sizeof(T) > src.size(), false);
+  std::memcpy(&val, src.data() + pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+/** строка, по которой видно, что data.zip поменялся.
+Всегда размер и время изменения: SHA256 считается не при каждом запуске,
+и смешивать его с размером нельзя - кэш сбрасывался бы через раз */
+static Str data_stamp() {
+#ifdef EDITOR
+  // редактор грузит ресурсы из папок, хватит ключей по содержимому
+  return {};
+#else
+  Str data_path = "data.zip";
+  if (hpw::config)
+    data_path = (*hpw::config)["path"].get_str("data", data_path);
+  data_path = hpw::cur_dir + data_path;
+  conv_sep(data_path);
+  try {
+    namespace fs = std::filesystem;
+    return n2s(fs::file_size(data_path)) + ":" +
+      n2s(fs::last_write_time(data_path).time_since_epoch().count());
+  } catch (CN<std::filesystem::filesystem_error> err) {
+    detailed_log("rotsprite cache: " << err.what() << '\n');
+  }
+  return {};
+#endif
+} // data_stamp
+
+/// удаляет давно не использованные файлы, пока кэш не влезет в лимиты
+static void trim_cache_dir(CN<Str> dir) {
+  namespace fs = std::filesystem;
+  struct Cached {
+    fs::path path {};
+    fs::file_time_type time {}; /// обновляется при каждом попадании в кэш
+    std::uintmax_t size {};
+  };
+  Vector<Cached> files;
+  std::uintmax_t total_size {};
+
+  try {
+    for (cnauto entry: fs::directory_iterator(dir)) {
+      cont_if ( !entry.is_regular_file());
+      if (entry.path().extension() != ".rot") {
+        // недописанные временные файлы от прошлого запуска
+        if (entry.path().filename() != "data.stamp")
+          fs::remove(entry.path());
+        continue;
+      }
+      files.emplace_back(entry.path(), entry.last_write_time(), entry.file_size());
+      total_size += files.back().size;
+    }
+    return_if (files.size() <= ROTSPRITE_CACHE_MAX_FILES
+      && total_size <= ROTSPRITE_CACHE_MAX_SIZE);
+
+    std::sort(files.begin(), files.end(),
+      [](CN<Cached> a, CN<Cached> b) { return a.time < b.time; });
+    std::size_t count = files.size();
+    for (cnauto file: files) {
+      break_if (count <= ROTSPRITE_CACHE_MAX_FILES && total_size <= ROTSPRITE_CACHE_MAX_SIZE);
+      fs::remove(file.path);
+      --count;
+      total_size -= file.size;
+    }
+    hpw_log("rotsprite cache: removed " << files.size() - count << " old files\n");
+  } catch (CN<fs::filesystem_error> err) {
+    hpw_log("rotsprite cache: " << err.what() << '\n');
+  }
+} // trim_cache_dir
+
+/** создаёт папку кэша и чистит её, если с прошлого запуска сменился data.zip
+* @return путь до папки кэша (в конце /) */
+static Str prepare_cache_dir() {
+  namespace fs = std::filesystem;
+  Str dir = hpw::cur_dir + "cache/";
+  make_dir_if_not_exist(dir);
+  dir += "rotsprite/";
+  make_dir_if_not_exist(dir);
+  conv_sep(dir);
+
+  cauto stamp = data_stamp();
+  cauto stamp_path = dir + "data.stamp";
+  Str old_stamp;
+  std::ifstream(stamp_path) >> old_stamp;
+  if (stamp.empty() || old_stamp == stamp) {
+    trim_cache_dir(dir);
+    return dir;
+  }
+
+  hpw_log("rotsprite cache: data changed, clear \"" << dir << "\"\n");
+  try {
+    for (cnauto entry: fs::directory_iterator(dir))
+      fs::remove(entry.path());
+  } catch (CN<fs::filesystem_error> err) {
+    hpw_log("rotsprite cache: " << err.what() << '\n');
+  }
+  std::ofstream(stamp_path) << stamp;
+  return dir;
+} // prepare_cache_dir
+
+static CN<Str> cache_dir() {
+  static const Str dir = prepare_cache_dir();
+  return dir;
+}
+
+/// имя файла в кэше по содержимому спрайта и параметрам поворота
+static Str make_key(CN<Sprite> src, real degree, const Vec offset,
+const Vec rotation_offset, Color_get_pattern cgp, Color_compute ccf) {
+  Bytes params;
+  push_pod(params, ROTSPRITE_CACHE_VERSION);
+  push_pod(params, src.X());
+  push_pod(params, src.Y());
+  push_pod(params, degree);
+  push_pod(params, offset.x);
+  push_pod(params, offset.y);
+  push_pod(params, rotation_offset.x);
+  push_pod(params, rotation_offset.y);
+  push_pod(params, scast<int>(cgp));
+  push_pod(params, scast<int>(ccf));
+
+  hash_sha256 hash;
+  hash.sha256_init();
+  hash.sha256_update(params.data(), params.size());
+  hash.sha256_update(cptr2ptr<CP<byte>>(src.get_image()->data()),
+    src.get_image()->size * sizeof(Pal8));
+  hash.sha256_update(cptr2ptr<CP<byte>>(src.get_mask()->data()),
+    src.get_mask()->size * sizeof(Pal8));
+  cauto sum = hash.sha256_final();
+
+  std::stringstream ss;
+  ss << std::hex << std::setfill('0');
+  for (cauto val: sum)
+    ss << std::setw(2) << int(val);
+  return ss.str();
+} // make_key
+
+/// @return false, если файла нет или он битый
+static bool load_cached(CN<Str> path, Sprite& dst, Vec& offset) {
+  std::ifstream file(path, std::ios_base::binary);
+  return_if ( !file, false);
+  const Bytes mem {std::istreambuf_iterator<char>(file), {}};
+
+  std::size_t pos {};
+  char magic[4] {};
+  std::uint32_t version {};
+  Vec loaded_offset;
+  int x {}, y {};
+  return_if ( !pop_pod(mem, pos, magic)
+    || std::memcmp(magic, ROTSPRITE_CACHE_MAGIC, sizeof(magic)) != 0, false);
+  return_if ( !pop_pod(mem, pos, version) || version != ROTSPRITE_CACHE_VERSION, false);
+  return_if ( !pop_pod(mem, pos, loaded_offset.x) || !pop_pod(mem, pos, loaded_offset.y), false);
+  return_if ( !pop_pod(mem, pos, x) || !pop_pod(mem, pos, y), false);
+  return_if (x <= 0 || y <= 0, false);
+  cauto pixels = scast<std::size_t>(x) * y;
+  return_if (mem.size() - pos != pixels * 2 * sizeof(Pal8), false);
+
+  dst.init(x, y);
+  std::memcpy(dst.get_image()->data(), mem.data() + pos, pixels * sizeof(Pal8));
+  pos += pixels * sizeof(Pal8);
+  std::memcpy(dst.edit_mask()->data(), mem.data() + pos, pixels * sizeof(Pal8));
+  offset = loaded_offset;
+  return true;
+} // load_cached
+
+static void save_cached(CN<Str> path, CN<Sprite> src, const Vec offset) {
+  return_if ( !src);
+  Bytes mem;
+  mem.reserve(32 + src.get_image()->size * 2 * sizeof(Pal8));
+  for (cauto ch: ROTSPRITE_CACHE_MAGIC)
+    push_pod(mem, ch);
+  push_pod(mem, ROTSPRITE_CACHE_VERSION);
+  push_pod(mem, offset.x);
+  push_pod(mem, offset.y);
+  push_pod(mem, src.X());
+  push_pod(mem, src.Y());
+  cauto image_p = cptr2ptr<CP<byte>>(src.get_image()->data());
+  mem.insert(mem.end(), image_p, image_p + src.get_image()->size * sizeof(Pal8));
+  cauto mask_p = cptr2ptr<CP<byte>>(src.get_mask()->data());
+  mem.insert(mem.end(), mask_p, mask_p + src.get_mask()->size * sizeof(Pal8));
+
+  // сначала во временный файл, чтобы другой поток не прочитал недописанное
+  cauto tmp_path = path + ".tmp" + n2s(omp_get_thread_num());
+  {
+    std::ofstream file(tmp_path, std::ios_base::binary);
+    if ( !file) {
+      detailed_log("rotsprite cache: file \"" << tmp_path << "\" not opened for save\n");
+      return;
+    }
+    file.write(cptr2ptr<CP<char>>(mem.data()), mem.size());
+  }
+  try {
+    std::filesystem::rename(tmp_path, path);
+  } catch (CN<std::filesystem::filesystem_error> err) {
+    detailed_log("rotsprite cache: " << err.what() << '\n');
+  }
+} // save_cached
+
+Sprite cached_rotate_and_optimize(CN<Sprite> src, real degree, Vec& offset,
+const Vec rotation_offset, Color_get_pattern cgp, Color_compute ccf) {
+  assert(src);
+  // без поворота считать нечего
+  if ( !graphic::enable_rotsprite_cache || degree == 0)
+    return rotate_and_optimize(src, degree, offset, rotation_offset, cgp, ccf);
+
+  cauto path = cache_dir() + make_key(src, degree, offset, rotation_offset, cgp, ccf) + ".rot";
+  Sprite ret;
+  if (load_cached(path, ret, offset)) {
+    // свежее время изменения - файл не удалится при чистке кэша
+    std::error_code err;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), err);
+    return ret;
+  }
+
+  ret = rotate_and_optimize(src, degree, offset, rotation_offset, cgp, ccf);
+  save_cached(path, ret, offset);
+  return ret;
+} // cached_rotate_and_optimize
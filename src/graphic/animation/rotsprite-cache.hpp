@@ -0,0 +1,15 @@
+#pragma once
+/** @file дисковый кэш для повёрнутых спрайтов.
+Ключ - SHA256 от содержимого исходного спрайта и параметров поворота,
+поэтому при смене картинки или настроек кадра кэш просто промахивается.
+Весь кэш сбрасывается, если у data.zip поменялись размер или время изменения.
+Размер кэша ограничен, при запуске удаляются давно не использованные файлы */
+#include "graphic/util/rotsprite.hpp"
+
+/// то же, что rotate_and_optimize, но сначала ищет результат на диске
+Sprite cached_rotate_and_optimize(
+  CN<Sprite> src, real degree, Vec& offset,
+  const Vec rotation_offset = {},
+  Color_get_pattern cgp = Color_get_pattern::cross,
+  Color_compute ccf = Color_compute::most_common
+);
@@ -118,14 +118,14 @@ bool Unifont::_load_glyph(char32_t ch) const {
     cfor (x, bitmap_w) {
       cnauto pix = bitmap[y * bitmap_w + x];
       glyph->image.get_image()->fast_set(x, y, pix > 127 ? Pal8::white : Pal8::black, {});
-      glyph->image.get_mask()->fast_set(x, y, pix > 127 ? Pal8::mask_visible : Pal8::mask_invisible, {});
+      glyph->image.edit_mask()->fast_set(x, y, pix > 127 ? Pal8::mask_visible : Pal8::mask_invisible, {});
     }
   } else {
     cfor (y, bitmap_h)
     cfor (x, bitmap_w) {
       cnauto pix = bitmap[y * bitmap_w + x];
       glyph->image.get_image()->fast_set(x, y, Pal8::get_gray(pix), {});
-      glyph->image.get_mask()->fast_set(x, y, Pal8::mask_visible, {});
+      glyph->image.edit_mask()->fast_set(x, y, Pal8::mask_visible, {});
     }
   }
   free(bitmap);
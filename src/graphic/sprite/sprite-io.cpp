@@ -32,19 +32,18 @@ inline void expand_contour(Image& image, CN<Image> mask) {
   } // for y, x
 } // expand_contour
 
-inline void _data_to_sprite(Sprite &dst, CN<File> file) {
-  iferror(file.data.empty(), "_data_to_sprite: file is empty");
+inline void _data_to_sprite(Sprite &dst, std::span<const byte> mem, CN<Str> file_path) {
+  iferror(mem.empty(), "_data_to_sprite: file is empty");
   // декодирование:
   int x, y;
   int comp; // сколько цветовых каналов
-  stbi_uc *decoded = stbi_load_from_memory( scast<CP<stbi_uc>>(file.data.data()),
-    file.data.size(), &x, &y, &comp, STBI_rgb_alpha );
-  iferror( !decoded, "_data_to_image: image data is not decoded. File: \"" << file.get_path() << "\"");
+  stbi_uc *decoded = stbi_load_from_memory( scast<CP<stbi_uc>>(mem.data()),
+    mem.size(), &x, &y, &comp, STBI_rgb_alpha );
+  iferror( !decoded, "_data_to_image: image data is not decoded. File: \"" << file_path << "\"");
 // переносим данные в спрайт:
   Image image(x, y);
   Image mask(x, y, Pal8::mask_invisible); // полностью прозрачная маска
   // привязать пути
-  auto file_path = file.get_path();
   image.set_path(file_path);
   mask.set_path(file_path);
   // сконвертировать цвета
@@ -68,16 +67,21 @@ inline void _data_to_sprite(Sprite &dst, CN<File> file) {
 
 void load(Sprite &dst, CN<File> file) {
   detailed_log("Sprite.load_file \"" << file.get_path() << "\"\n");
-  _data_to_sprite(dst, file);
+  _data_to_sprite(dst, file.data, file.get_path());
 } // load
 
+void load(Sprite &dst, std::span<const byte> mem, CN<Str> path) {
+  detailed_log("Sprite.load_view \"" << path << "\"\n");
+  _data_to_sprite(dst, mem, path);
+}
+
 void load(Sprite &dst, CN<Str> name) {
   detailed_log("Sprite.load_file(F) \"" << name << "\"\n");
   File file {mem_from_file(name), name};
-  _data_to_sprite(dst, file);
+  _data_to_sprite(dst, file.data, file.get_path());
 } // load
 
 void load(CN<File> file, Sprite &dst) {
   iferror( file.data.empty(), "load sprite(M): file is empty");
-  _data_to_sprite(dst, file);
+  _data_to_sprite(dst, file.data, file.get_path());
 }
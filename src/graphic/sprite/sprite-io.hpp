@@ -1,12 +1,16 @@
 #pragma once
+#include <span>
 #include "util/macro.hpp"
 #include "util/str.hpp"
+#include "util/math/num-types.hpp"
 
 struct File;
 class Sprite;
 
 /// load from mem
 void load(Sprite &dst, CN<File> file);
+/// load from mem without copying, path is only for the error messages
+void load(Sprite &dst, std::span<const byte> mem, CN<Str> path);
 /// load from file
 void load(Sprite &dst, CN<Str> name);
 /// load from memory
@@ -2,18 +2,23 @@
 #include <utility>
 #include "sprite.hpp"
 #include "graphic/image/image.hpp"
+#include "graphic/util/blit.hpp"
 
 void Sprite::set_image(CN<Image> image) noexcept
   { _image = new_shared<Image>(image); }
 
-void Sprite::set_mask(CN<Image> mask) noexcept
-  { _mask = new_shared<Image>(mask); }
+void Sprite::set_mask(CN<Image> mask) noexcept {
+  _mask = new_shared<Image>(mask);
+  _spans = {};
+}
 
 void Sprite::move_image(Image&& image) noexcept
   { _image = new_shared<Image>(std::move(image)); }
 
-void Sprite::move_mask(Image&& mask) noexcept
-  { _mask = new_shared<Image>(std::move(mask)); }
+void Sprite::move_mask(Image&& mask) noexcept {
+  _mask = new_shared<Image>(std::move(mask));
+  _spans = {};
+}
 
 Sprite::Sprite(CN<Sprite> other) noexcept { init(other); }
 
@@ -26,13 +31,15 @@ Sprite& Sprite::operator = (CN<Sprite> other) noexcept {
 
 Sprite::Sprite(Sprite&& other) noexcept
 : _image(std::move(other._image))
-, _mask(std::move(other._mask)) {}
+, _mask(std::move(other._mask))
+, _spans(std::move(other._spans)) {}
 
 Sprite& Sprite::operator = (Sprite&& other) noexcept {
   if (this == std::addressof(other))
     return *this;
   _image = std::move(other._image);
   _mask = std::move(other._mask);
+  _spans = std::move(other._spans);
   return *this;
 }
 
@@ -40,6 +47,8 @@ void Sprite::init(CN<Sprite> other) noexcept {
   return_if (this == std::addressof(other));
   set_image(*other.get_image());
   set_mask(*other.get_mask());
+  // маска та же, разметку можно не строить заново
+  _spans = other._spans;
 }
 
 void Sprite::init(int new_x, int new_y) noexcept {
@@ -61,3 +70,25 @@ Sprite::operator bool() const {
 
 int Sprite::X() const { return _image ? _image->X : 0; }
 int Sprite::Y() const { return _image ? _image->Y : 0; }
+
+void Sprite::update_spans() {
+  _spans = {};
+  return_if (!_mask || !*_mask);
+
+  auto spans = new_shared<Sprite_spans>();
+  spans->rows.reserve(_mask->Y + 1);
+  cfor (y, _mask->Y) {
+    spans->rows.push_back(spans->spans.size());
+    cauto row = _mask->data() + y * _mask->X;
+    int x = 0;
+    while (x < _mask->X) {
+      x += blit::run_len(row + x, _mask->X - x, false);
+      cauto len = blit::run_len(row + x, _mask->X - x, true);
+      if (len > 0)
+        spans->spans.emplace_back(Opaque_span{.x = x, .len = len});
+      x += len;
+    }
+  }
+  spans->rows.push_back(spans->spans.size());
+  _spans = spans;
+} // update_spans
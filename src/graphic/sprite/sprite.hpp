@@ -1,22 +1,49 @@
 #pragma once
+#include <span>
 #include "game/util/resource.hpp"
 #include "util/math/vec.hpp"
 #include "util/mem-types.hpp"
 
 class Image;
 
+/// непрерывный участок видимых пикселей в строке маски
+struct Opaque_span {
+  int x {};   /// начало участка в строке
+  int len {}; /// сколько пикселей подряд видимы
+};
+
+/// RLE-разметка маски: видимые участки по строкам
+struct Sprite_spans {
+  Vector<Opaque_span> spans {};
+  Vector<std::uint32_t> rows {}; /// индекс первого участка строки y в spans (размер Y + 1)
+
+  inline std::span<const Opaque_span> row(int y) const
+    { return {spans.data() + rows[y], spans.data() + rows[y + 1]}; }
+};
+
 class Sprite final: public Resource {
 protected:
   Shared<Image> _image {};
   Shared<Image> _mask {}; /// маска прозрачности. white - 100% alpha
+  Shared<Sprite_spans> _spans {}; /// видимые участки маски. Пусто, если не построены
 
 public:
   int X() const;
   int Y() const;
   inline Image* get_image() { return _image.get(); }
   inline Image* get_mask() { return _mask.get(); }
+  /// маска для изменения пикселей: разметка участков сбрасывается
+  inline Image* edit_mask() {
+    if (_spans) // пустую не трогать, чтобы можно было звать из omp-цикла
+      _spans = {};
+    return _mask.get();
+  }
   inline CP<Image> get_image() const { return _image.get(); }
   inline CP<Image> get_mask() const { return _mask.get(); }
+  /// @return видимые участки маски или nullptr, если их не строили
+  inline CP<Sprite_spans> get_spans() const { return _spans.get(); }
+  /// построить видимые участки по текущей маске (вызывать после изменения маски)
+  void update_spans();
   void set_image(CN<Image> image) noexcept;
   void set_mask(CN<Image> mask) noexcept;
   void move_image(Image&& image) noexcept;
@@ -0,0 +1,143 @@
+#include <bit>
+#include <cassert>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#include "blit.hpp"
+
+namespace blit {
+
+int run_len(CP<Pal8> mask, const int len, const bool visible) {
+  int i = 0;
+
+#ifdef __SSE2__
+  // по 16 пикселей за раз ищем первый, у которого видимость другая
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= len; i += 16) {
+    cauto m = _mm_loadu_si128(rcast<const __m128i*>(mask + i));
+    const uint visible_bits = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(m, one), zero));
+    const uint other_bits = visible ? (~visible_bits & 0xFFFFu) : visible_bits;
+    if (other_bits)
+      return i + std::countr_zero(other_bits);
+  }
+#endif
+
+  for (; i < len; ++i)
+    if (is_visible(mask[i]) != visible)
+      return i;
+  return len;
+} // run_len
+
+void row_past(Pal8* dst, CP<Pal8> src, CP<Pal8> mask, const int len) {
+  int x = 0;
+
+#if defined(__AVX2__)
+  const __m256i one = _mm256_set1_epi8(1);
+  const __m256i zero = _mm256_setzero_si256();
+  for (; x + 32 <= len; x += 32) {
+    cauto m = _mm256_loadu_si256(rcast<const __m256i*>(mask + x));
+    cauto s = _mm256_loadu_si256(rcast<const __m256i*>(src + x));
+    cauto d = _mm256_loadu_si256(rcast<const __m256i*>(dst + x));
+    cauto visible = _mm256_cmpeq_epi8(_mm256_and_si256(m, one), zero);
+    _mm256_storeu_si256(rcast<__m256i*>(dst + x), _mm256_blendv_epi8(d, s, visible));
+  }
+#elif defined(__SSE2__)
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i zero = _mm_setzero_si128();
+  for (; x + 16 <= len; x += 16) {
+    cauto m = _mm_loadu_si128(rcast<const __m128i*>(mask + x));
+    cauto s = _mm_loadu_si128(rcast<const __m128i*>(src + x));
+    cauto d = _mm_loadu_si128(rcast<const __m128i*>(dst + x));
+    cauto visible = _mm_cmpeq_epi8(_mm_and_si128(m, one), zero);
+    // (s & visible) | (d & ~visible)
+    cauto ret = _mm_or_si128(_mm_and_si128(visible, s), _mm_andnot_si128(visible, d));
+    _mm_storeu_si128(rcast<__m128i*>(dst + x), ret);
+  }
+#endif
+
+  for (; x < len; ++x)
+    if (is_visible(mask[x]))
+      dst[x] = src[x];
+} // row_past
+
+CP<byte> find_table(blend_pf bf) {
+  struct Table_info {
+    blend_pf bf {};
+    CN<Bytes> table;
+  };
+  // только бленды вида table[in * 256 + bg] без optional
+  static const Table_info tables[] {
+    {&blend_or,        table_or},
+    {&blend_sub,       table_sub},
+    {&blend_add,       table_add},
+    {&blend_mul,       table_mul},
+    {&blend_and,       table_and},
+    {&blend_min,       table_min},
+    {&blend_max,       table_max},
+    {&blend_avr,       table_avr},
+    {&blend_avr_max,   table_avr_max},
+    {&blend_158,       table_blend158},
+    {&blend_diff,      table_diff},
+    {&blend_xor,       table_xor},
+    {&blend_xor_safe,  table_xor_safe},
+    {&blend_overlay,   table_overlay},
+    {&blend_or_safe,   table_or_safe},
+    {&blend_add_safe,  table_add_safe},
+    {&blend_sub_safe,  table_sub_safe},
+    {&blend_mul_safe,  table_mul_safe},
+    {&blend_and_safe,  table_and_safe},
+    {&blend_softlight, table_softlight},
+  };
+
+  for (cnauto it: tables)
+    if (it.bf == bf)
+      return it.table.empty() ? nullptr : it.table.data();
+  return nullptr;
+}
+
+} // blit ns
+
+Sprite_row_blitter::Sprite_row_blitter(blend_pf bf, int optional)
+: m_bf {bf}
+, m_optional {optional}
+, m_table {bf == &blend_past ? nullptr : blit::find_table(bf)}
+{ assert(m_bf); }
+
+void Sprite_row_blitter::operator()(Pal8* dst, CP<Pal8> src, CP<Pal8> mask,
+const int len) const {
+  if (m_bf == &blend_past) {
+    blit::row_past(dst, src, mask, len);
+    return;
+  }
+
+  // табличный бленд без вызова через указатель
+  if (m_table) {
+    blit::row(dst, src, mask, len, [table = m_table](const Pal8 in, const Pal8 bg)
+      { return Pal8(table[uint(in.val) * 256 + uint(bg.val)]); });
+    return;
+  }
+
+  blit::row(dst, src, mask, len, [bf = m_bf, optional = m_optional]
+    (const Pal8 in, const Pal8 bg) { return bf(in, bg, optional); });
+}
+
+void Sprite_row_blitter::span(Pal8* dst, CP<Pal8> src, const int len) const {
+  if (m_bf == &blend_past) {
+    std::memcpy(dst, src, len * sizeof(Pal8));
+    return;
+  }
+
+  if (m_table) {
+    blit::span(dst, src, len, [table = m_table](const Pal8 in, const Pal8 bg)
+      { return Pal8(table[uint(in.val) * 256 + uint(bg.val)]); });
+    return;
+  }
+
+  blit::span(dst, src, len, [bf = m_bf, optional = m_optional]
+    (const Pal8 in, const Pal8 bg) { return bf(in, bg, optional); });
+}
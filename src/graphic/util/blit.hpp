@@ -0,0 +1,56 @@
+#pragma once
+/// @file построчная отрисовка спрайтов по маске
+#include "graphic/image/color-blend.hpp"
+
+static_assert(sizeof(Pal8) == 1);
+
+namespace blit {
+
+/// пиксель маски видим, если его младший бит 0 (как в insert)
+[[nodiscard]] inline bool is_visible(const Pal8 mask) { return (mask.val & 1) == 0; }
+
+/** сколько пикселей подряд с начала строки имеют видимость visible
+* @param len длина строки маски */
+[[nodiscard]] int run_len(CP<Pal8> mask, const int len, const bool visible);
+
+/// вставка строки без смешивания (SSE2/AVX2, если есть)
+void row_past(Pal8* dst, CP<Pal8> src, CP<Pal8> mask, const int len);
+
+/// @return таблица 256x256 для бленда [in * 256 + bg] или nullptr
+[[nodiscard]] CP<byte> find_table(blend_pf bf);
+
+/** вставка строки спрайта. Невидимые участки по маске пропускаются
+целиком, видимые смешиваются через blend(in, bg) */
+template <class Blend>
+inline void row(Pal8* dst, CP<Pal8> src, CP<Pal8> mask, const int len, Blend&& blend) {
+  int x = 0;
+  while (x < len) {
+    x += run_len(mask + x, len - x, false);
+    cauto end = x + run_len(mask + x, len - x, true);
+    for (; x < end; ++x)
+      dst[x] = blend(src[x], dst[x]);
+  }
+}
+
+/// вставка участка, где все пиксели видимы: маску не проверяет
+template <class Blend>
+inline void span(Pal8* dst, CP<Pal8> src, const int len, Blend&& blend) {
+  cfor (x, len)
+    dst[x] = blend(src[x], dst[x]);
+}
+
+} // blit ns
+
+/** рисует строки спрайта самым быстрым способом для bf. Способ
+выбирается один раз. Результат такой же, как при попиксельном bf по маске */
+class Sprite_row_blitter final {
+  blend_pf m_bf {};
+  int m_optional {};
+  CP<byte> m_table {}; /// таблица бленда, если bf табличный
+
+public:
+  explicit Sprite_row_blitter(blend_pf bf, int optional=0);
+  void operator()(Pal8* dst, CP<Pal8> src, CP<Pal8> mask, const int len) const;
+  /// отрисовка заранее найденного видимого участка (см. Sprite_spans)
+  void span(Pal8* dst, CP<Pal8> src, const int len) const;
+};
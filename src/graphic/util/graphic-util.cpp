@@ -5,6 +5,7 @@
 #include <cmath>
 #include "graphic-util.hpp"
 #include "util-templ.hpp"
+#include "blit.hpp"
 #include "graphic/image/image.hpp"
 #include "graphic/sprite/sprite.hpp"
 #include "util/math/random.hpp"
@@ -234,6 +235,28 @@ void insert(Image& dst, CN<Sprite> src, Vec pos, blend_pf bf, int optional) {
   // начальное смещение dst по y с оффсетом
   dst_p += (sy + scast<int>(pos.y)) * dst.X;
 
+  const Sprite_row_blitter blit_row(bf, optional);
+
+  // по RLE-разметке маски прозрачные участки вообще не просматриваются
+  if (cauto spans = src.get_spans(); spans) {
+    assert(spans->rows.size() == scast<std::size_t>(src_mask->Y) + 1);
+    cauto pos_x = scast<int>(pos.x);
+    cauto pos_y = scast<int>(pos.y);
+    for (auto y = sy; y < ey; ++y) {
+      cauto src_row = src_image->data() + y * src_image->X;
+      cauto dst_row = dst.data() + (y + pos_y) * dst.X;
+      for (cnauto span: spans->row(y)) {
+        break_if (span.x >= ex);
+        cauto x0 = std::max(span.x, sx);
+        cauto x1 = std::min(span.x + span.len, ex);
+        cont_if (x0 >= x1);
+        blit_row.span(dst_row + (pos_x + x0), src_row + x0, x1 - x0);
+      }
+    }
+    return;
+  }
+
+  cauto row_len = ex - sx;
   for (auto y = sy; y < ey; ++y) {
     // смещение по x (левый пич)
     dst_p += dst_front_poch;
@@ -241,16 +264,10 @@ void insert(Image& dst, CN<Sprite> src, Vec pos, blend_pf bf, int optional) {
     src_p += src_front_poch;
 
     // отрисовка строки
-    for (auto x = sx; x < ex; ++x) {
-      // табличная оптимизация без использования ветвления:
-      const Pal8 SRC_DST[2] {bf(*src_p, *dst_p, optional), *dst_p};
-      *dst_p = SRC_DST[mask_p->val & 1];
-
-      // движение по строке
-      ++src_p;
-      ++mask_p;
-      ++dst_p;
-    }
+    blit_row(dst_p, src_p, mask_p, row_len);
+    src_p += row_len;
+    mask_p += row_len;
+    dst_p += row_len;
 
     // смещение по x (правый пич)
     dst_p += dst_back_porch;
@@ -6,6 +6,7 @@
 #include "resize.hpp"
 #include "graphic/image/image.hpp"
 #include "graphic/sprite/sprite.hpp"
+#include "util/error.hpp"
 #include "util/log.hpp"
 
 void zoom_x2(Image& dst) {
@@ -26,7 +27,7 @@ void zoom_x2(Image& dst) {
 void zoom_x2(Sprite& dst) {
   assert(dst);
   zoom_x2(*dst.get_image());
-  zoom_x2(*dst.get_mask());
+  zoom_x2(*dst.edit_mask());
 }
 
 void zoom_x8(Image& dst) {
@@ -70,37 +71,115 @@ void zoom_x4(Image& dst) {
 void zoom_x4(Sprite& dst) {
   assert(dst);
   zoom_x4(*dst.get_image());
-  zoom_x4(*dst.get_mask());
+  zoom_x4(*dst.edit_mask());
 }
 
 void zoom_x8(Sprite& dst) {
   assert(dst);
   zoom_x8(*dst.get_image());
-  zoom_x8(*dst.get_mask());
+  zoom_x8(*dst.edit_mask());
+}
+
+/// выборка по паттерну крест. edge - пиксель у края и нужно отражение
+template <bool edge>
+inline static std::size_t get_cross(CN<Image> src, int x, int y, Color_samples& dst) {
+  if constexpr (edge) {
+    constexpr auto mode = Image_get::MIRROR;
+    dst[0] = src.get(x + 0, y - 1, mode);
+    dst[1] = src.get(x - 1, y + 0, mode);
+    dst[2] =     src(x + 0, y + 0);
+    dst[3] = src.get(x + 1, y + 0, mode);
+    dst[4] = src.get(x + 0, y + 1, mode);
+  } else {
+    cauto p = src.data() + y * src.X + x;
+    dst[0] = p[-src.X];
+    dst[1] = p[-1];
+    dst[2] = p[0];
+    dst[3] = p[1];
+    dst[4] = p[src.X];
+  }
+  return 5;
+}
+
+/// выборка по паттерну квадрат. edge - пиксель у края и нужно отражение
+template <bool edge>
+inline static std::size_t get_box(CN<Image> src, int x, int y, Color_samples& dst) {
+  if constexpr (edge) {
+    constexpr auto mode = Image_get::MIRROR;
+    dst[0] = src.get(x - 1, y - 1, mode);
+    dst[1] = src.get(x + 0, y - 1, mode);
+    dst[2] = src.get(x + 1, y - 1, mode);
+    dst[3] = src.get(x - 1, y + 0, mode);
+    dst[4] =     src(x + 0, y + 0);
+    dst[5] = src.get(x + 1, y + 0, mode);
+    dst[6] = src.get(x - 1, y + 1, mode);
+    dst[7] = src.get(x + 0, y + 1, mode);
+    dst[8] = src.get(x + 1, y + 1, mode);
+  } else {
+    cauto up = src.data() + (y - 1) * src.X + x;
+    cauto mid = up + src.X;
+    cauto down = mid + src.X;
+    dst[0] = up[-1];   dst[1] = up[0];   dst[2] = up[1];
+    dst[3] = mid[-1];  dst[4] = mid[0];  dst[5] = mid[1];
+    dst[6] = down[-1]; dst[7] = down[0]; dst[8] = down[1];
+  }
+  return 9;
+}
+
+/** строка даунскейла без выделений памяти: цвета выбираются в массив на стеке
+* @tparam box паттерн квадрат, иначе крест
+* @param ccf функция выбора цвета */
+template <bool box, class Compute>
+static void downscale_row(CN<Image> src, Pal8* dst, int y, Compute&& ccf) {
+  cauto dst_x = src.X / 3;
+  cauto sy = y * 3;
+  // на краях нужно отражение (y - 1 и x - 1 уходят за картинку)
+  const bool edge_row = sy == 0;
+  Color_samples colors;
+
+  cfor (x, dst_x) {
+    cauto sx = x * 3;
+    std::size_t count;
+    if (edge_row || sx == 0)
+      count = box ? get_box<true>(src, sx, sy, colors) : get_cross<true>(src, sx, sy, colors);
+    else
+      count = box ? get_box<false>(src, sx, sy, colors) : get_cross<false>(src, sx, sy, colors);
+    dst[x] = ccf(std::span<const Pal8>(colors.data(), count));
+  }
+}
+
+/// выбирает функцию цвета один раз на строку
+template <bool box>
+static void downscale_row_by_ccf(CN<Image> src, Pal8* dst, int y, Color_compute ccf) {
+  switch (ccf) {
+    case Color_compute::most_common: downscale_row<box>(src, dst, y, &most_common_col); break;
+    case Color_compute::max: downscale_row<box>(src, dst, y, &max_col); break;
+    case Color_compute::min: downscale_row<box>(src, dst, y, &min_col); break;
+    case Color_compute::average: downscale_row<box>(src, dst, y, &average_col); break;
+    default: error("unknown Color_compute: " << scast<int>(ccf));
+  }
+}
+
+void pixel_downscale_x3_row(CN<Image> src, Pal8* dst, int y,
+Color_get_pattern cgp, Color_compute ccf) {
+  assert(src);
+  assert(dst);
+  assert(y >= 0 && y < src.Y / 3);
+  switch (cgp) {
+    case Color_get_pattern::cross: downscale_row_by_ccf<false>(src, dst, y, ccf); break;
+    case Color_get_pattern::box: downscale_row_by_ccf<true>(src, dst, y, ccf); break;
+    default: error("unknown Color_get_pattern: " << scast<int>(cgp));
+  }
 }
 
 Image pixel_downscale_x3(CN<Image> src, Color_get_pattern cgp, Color_compute ccf) {
   if (!src)
     return src;
-  sconst std::unordered_map<Color_get_pattern, decltype(color_get_cross)*> cgp_table {
-    {Color_get_pattern::cross, &color_get_cross},
-    {Color_get_pattern::box, &color_get_box},
-  };
-  sconst std::unordered_map<Color_compute, decltype(most_common_col)*> ccf_table {
-    {Color_compute::most_common, &most_common_col},
-    {Color_compute::max, &max_col},
-    {Color_compute::min, &min_col},
-    {Color_compute::average, &average_col},
-  };
 
   auto dst = Image(src.X / 3, src.Y / 3);
-  #pragma omp parallel for simd schedule(static, 4) collapse(2)
+  #pragma omp parallel for schedule(static, 4)
   cfor (y, dst.Y)
-  cfor (x, dst.X) {
-    auto colors = cgp_table.at(cgp) (src, x * 3, y * 3);
-    auto pix = ccf_table.at(ccf) (colors);
-    dst.fast_set(x, y, pix, {});
-  }
+    pixel_downscale_x3_row(src, dst.data() + y * dst.X, y, cgp, ccf);
   return dst;
 } // pixel_downscale_x3
 
@@ -129,79 +208,79 @@ Sprite pixel_downscale_x3(CN<Sprite> src, Color_get_pattern cgp, Color_compute c
 Image pixel_upscale_x3(CN<Image> src) {
 // scale 3x algorithm
   Image dst(src.X * 3, src.Y * 3);
-  Pal8 P1, P2, P3;
-  Pal8 P4, P5, P6;
-  Pal8 P7, P8, P9;
-  cfor (y, src.Y)
-  cfor (x, src.X) {
-    auto A {src.get(x - 1, y - 1, Image_get::COPY)};
-    auto B {src.get(x + 0, y - 1, Image_get::COPY)};
-    auto C {src.get(x + 1, y - 1, Image_get::COPY)};
-    auto D {src.get(x - 1, y + 0, Image_get::COPY)};
-    auto E {src(x, y)};
-    auto F {src.get(x + 1, y + 0, Image_get::COPY)};
-    auto G {src.get(x - 1, y + 1, Image_get::COPY)};
-    auto H {src.get(x + 0, y + 1, Image_get::COPY)};
-    auto I {src.get(x + 1, y + 1, Image_get::COPY)};
-    if (B != H && D != F) {
-      P1 = D == B ? D : E;
-      P2 = (D == B && E != C) || (B == F && E != A) ? B : E;
-      P3 = B == F ? F : E;
-      P4 = (D == B && E != G) || (D == H && E != A) ? D : E;
-      P5 = E;
-      P6 = (B == F && E != I) || (H == F && E != C) ? F : E;
-      P7 = D == H ? D : E;
-      P8 = (D == H && E != I) || (H == F && E != G) ? H : E;
-      P9 = H == F ? F : E;
-    } else {
-      P1 = E; P2 = E; P3 = E;
-      P4 = E; P5 = E; P6 = E;
-      P7 = E; P8 = E; P9 = E;
-    }
-    #pragma omp critical (pixel_upscale_x3_dst)
-    { 
-      dst.fast_set(x * 3 + 0, y * 3 + 0, P1, {});
-      dst.fast_set(x * 3 + 1, y * 3 + 0, P2, {});
-      dst.fast_set(x * 3 + 2, y * 3 + 0, P3, {});
-      dst.fast_set(x * 3 + 0, y * 3 + 1, P4, {});
-      dst.fast_set(x * 3 + 1, y * 3 + 1, P5, {});
-      dst.fast_set(x * 3 + 2, y * 3 + 1, P6, {});
-      dst.fast_set(x * 3 + 0, y * 3 + 2, P7, {});
-      dst.fast_set(x * 3 + 1, y * 3 + 2, P8, {});
-      dst.fast_set(x * 3 + 2, y * 3 + 2, P9, {});
-    }
-  }
+  return_if (!src, dst);
+
+  // строки пишутся в разные места dst, поэтому их можно считать параллельно
+  #pragma omp parallel for schedule(static, 4)
+  cfor (y, src.Y) {
+    // края копируются (как Image_get::COPY)
+    cauto up   = src.data() + std::max(y - 1, 0) * src.X;
+    cauto mid  = src.data() + y * src.X;
+    cauto down = src.data() + std::min(y + 1, src.Y - 1) * src.X;
+    auto dst_0 = dst.data() + (y * 3 + 0) * dst.X;
+    auto dst_1 = dst_0 + dst.X;
+    auto dst_2 = dst_1 + dst.X;
+
+    cfor (x, src.X) {
+      cauto l = std::max(x - 1, 0);
+      cauto r = std::min(x + 1, src.X - 1);
+      cauto A {up[l]};   cauto B {up[x]};   cauto C {up[r]};
+      cauto D {mid[l]};  cauto E {mid[x]};  cauto F {mid[r]};
+      cauto G {down[l]}; cauto H {down[x]}; cauto I {down[r]};
+      cauto dx = x * 3;
+
+      if (B != H && D != F) {
+        dst_0[dx + 0] = D == B ? D : E;
+        dst_0[dx + 1] = (D == B && E != C) || (B == F && E != A) ? B : E;
+        dst_0[dx + 2] = B == F ? F : E;
+        dst_1[dx + 0] = (D == B && E != G) || (D == H && E != A) ? D : E;
+        dst_1[dx + 1] = E;
+        dst_1[dx + 2] = (B == F && E != I) || (H == F && E != C) ? F : E;
+        dst_2[dx + 0] = D == H ? D : E;
+        dst_2[dx + 1] = (D == H && E != I) || (H == F && E != G) ? H : E;
+        dst_2[dx + 2] = H == F ? F : E;
+      } else {
+        dst_0[dx + 0] = E; dst_0[dx + 1] = E; dst_0[dx + 2] = E;
+        dst_1[dx + 0] = E; dst_1[dx + 1] = E; dst_1[dx + 2] = E;
+        dst_2[dx + 0] = E; dst_2[dx + 1] = E; dst_2[dx + 2] = E;
+      }
+    } // for x
+  } // for y
   return dst;
 } // pixel_upscale_x3
 
-Pal8 most_common_col(CN<Vector<Pal8>> colors) {
+Pal8 most_common_col(std::span<const Pal8> colors) {
+  assert(!colors.empty());
   std::size_t max_count {};
   CP<Pal8> ret {};
 
-  for (cnauto a: colors) {
-    std::size_t count {};
-    for (cnauto b: colors)
-      if (a == b)
-        ++count;
+  cfor (i, colors.size()) {
+    cnauto a = colors[i];
+    cauto begin = colors.begin() + i;
+    // такой цвет уже встречался раньше и посчитан
+    cont_if (std::find(colors.begin(), begin, a) != begin);
 
+    cauto count = scast<std::size_t>(std::count(begin, colors.end(), a));
     if (count > max_count) {
       max_count = count;
       ret = &a;
     }
-  } // for a: colors
+    // у цвета больше половины выборки: другой столько уже не наберёт
+    break_if (max_count * 2 > colors.size());
+  } // for colors
 
   return *ret;
 } // most_common_col
 
-Pal8 max_col(CN<Vector<Pal8>> colors) {
+Pal8 max_col(std::span<const Pal8> colors) {
   return *std::max_element(colors.begin(), colors.end());
 }
 
-Pal8 min_col(CN<Vector<Pal8>> colors) {
+Pal8 min_col(std::span<const Pal8> colors) {
   return *std::min_element(colors.begin(), colors.end());
 }
 
-Pal8 average_col(CN<Vector<Pal8>> colors) {
+Pal8 average_col(std::span<const Pal8> colors) {
   real ret = 0;
   bool is_red = false;
   for (cnauto color: colors) {
@@ -211,31 +290,11 @@ Pal8 average_col(CN<Vector<Pal8>> colors) {
   return Pal8::from_real(ret / colors.size(), is_red);
 }
 
-Vector<Pal8> color_get_cross(CN<Image> src, int x, int y) {
-  Vector<Pal8> ret(5);
-  auto mode = Image_get::MIRROR;
-  ret[0] = src.get(x + 0, y - 1, mode);
-  ret[1] = src.get(x - 1, y + 0, mode);
-  ret[2] =     src(x + 0, y + 0);
-  ret[3] = src.get(x + 1, y + 0, mode);
-  ret[4] = src.get(x + 0, y + 1, mode);
-  return ret;
-}
+std::size_t color_get_cross(CN<Image> src, int x, int y, Color_samples& dst)
+  { return get_cross<true>(src, x, y, dst); }
 
-Vector<Pal8> color_get_box(CN<Image> src, int x, int y) {
-  Vector<Pal8> ret(9);
-  auto mode = Image_get::MIRROR;
-  ret[0] = src.get(x - 1, y - 1, mode);
-  ret[1] = src.get(x + 0, y - 1, mode);
-  ret[2] = src.get(x + 1, y - 1, mode);
-  ret[3] = src.get(x - 1, y + 0, mode);
-  ret[4] =     src(x + 0, y + 0);
-  ret[5] = src.get(x + 1, y + 0, mode);
-  ret[6] = src.get(x - 1, y + 1, mode);
-  ret[7] = src.get(x + 0, y + 1, mode);
-  ret[8] = src.get(x + 1, y + 1, mode);
-  return ret;
-}
+std::size_t color_get_box(CN<Image> src, int x, int y, Color_samples& dst)
+  { return get_box<true>(src, x, y, dst); }
 
 Str convert(Color_compute ccf) {
   std::unordered_map<Color_compute, Str> table {
@@ -1,4 +1,7 @@
 #pragma once
+#include <array>
+#include <span>
+#include "graphic/image/color.hpp"
 #include "util/macro.hpp"
 #include "util/str.hpp"
 #include "util/vector-types.hpp"
@@ -6,8 +9,6 @@
 class Image;
 class Sprite;
 
-struct Pal8;
-
 enum class Color_compute {
   most_common = 0,
   max,
@@ -44,18 +45,28 @@ Sprite pixel_downscale_x3(CN<Sprite> src,
 Image pixel_downscale_x3(CN<Image> src,
   Color_get_pattern cgp = Color_get_pattern::cross,
   Color_compute ccf = Color_compute::most_common);
-// паттерн выборки пикселей крест
-Vector<Pal8> color_get_cross(CN<Image> src, int x, int y);
-// паттерн выборки пикселей квадрат
-Vector<Pal8> color_get_box(CN<Image> src, int x, int y);
+/** уменьшает в 3 раза одну строку картинки
+* @param src исходная картинка
+* @param dst строка результата шириной src.X / 3
+* @param y номер строки результата */
+void pixel_downscale_x3_row(CN<Image> src, Pal8* dst, int y,
+  Color_get_pattern cgp = Color_get_pattern::cross,
+  Color_compute ccf = Color_compute::most_common);
+
+/// выборка цветов для даунскейла (паттерны берут не больше 9 пикселей)
+using Color_samples = std::array<Pal8, 9>;
+// паттерн выборки пикселей крест. @return число цветов в dst
+std::size_t color_get_cross(CN<Image> src, int x, int y, Color_samples& dst);
+// паттерн выборки пикселей квадрат. @return число цветов в dst
+std::size_t color_get_box(CN<Image> src, int x, int y, Color_samples& dst);
 // возвращает самый частый цвет
-Pal8 most_common_col(CN<Vector<Pal8>> colors);
+Pal8 most_common_col(std::span<const Pal8> colors);
 // возвращает самый яркий цвет
-Pal8 max_col(CN<Vector<Pal8>> colors);
+Pal8 max_col(std::span<const Pal8> colors);
 // возвращает самый тёмный цвет
-Pal8 min_col(CN<Vector<Pal8>> colors);
+Pal8 min_col(std::span<const Pal8> colors);
 // среднее между цветами
-Pal8 average_col(CN<Vector<Pal8>> colors);
+Pal8 average_col(std::span<const Pal8> colors);
 
 /// Color_compute -> Str
 Str convert(Color_compute ccf);
@@ -91,5 +91,5 @@ const Vec offset, real degree) {
 void rotate(CN<Sprite> src, Sprite &dst, const Vec center,
 const Vec offset, real degree) {
   rotate(*src.get_image(), *dst.get_image(), center, offset, degree);
-  rotate(*src.get_mask(), *dst.get_mask(), center, offset, degree);
+  rotate(*src.get_mask(), *dst.edit_mask(), center, offset, degree);
 }
@@ -7,6 +7,7 @@
 #include "graphic/sprite/sprite.hpp"
 #include "graphic/image/image.hpp"
 #include "graphic/image/color-blend.hpp"
+#include "graphic/util/blit.hpp"
 //#include "graphic/util/graphic-util.hpp"
 #include "util/math/vec.hpp"
 #include "util/math/vec-util.hpp"
@@ -370,6 +371,31 @@ void insert(Image& dst, CN<Sprite> src, Vec pos, int optional) {
   // начальное смещение dst по y с оффсетом
   dst_p += (sy + scast<int>(pos.y)) * dst.X;
 
+  // по RLE-разметке маски прозрачные участки вообще не просматриваются
+  if (cauto spans = src.get_spans(); spans) {
+    assert(spans->rows.size() == scast<std::size_t>(src_mask.Y) + 1);
+    cauto pos_x = scast<int>(pos.x);
+    cauto pos_y = scast<int>(pos.y);
+    for (auto y = sy; y < ey; ++y) {
+      cauto src_row = src_image.data() + y * src_image.X;
+      cauto dst_row = dst.data() + (y + pos_y) * dst.X;
+      for (cnauto span: spans->row(y)) {
+        break_if (span.x >= ex);
+        cauto x0 = std::max(span.x, sx);
+        cauto x1 = std::min(span.x + span.len, ex);
+        cont_if (x0 >= x1);
+        if constexpr (bf == &blend_past) {
+          std::copy_n(src_row + x0, x1 - x0, dst_row + (pos_x + x0));
+        } else {
+          blit::span(dst_row + (pos_x + x0), src_row + x0, x1 - x0,
+            [optional](const Pal8 in, const Pal8 bg) { return bf(in, bg, optional); });
+        }
+      }
+    }
+    return;
+  }
+
+  cauto row_len = ex - sx;
   for (auto y = sy; y < ey; ++y) {
     // смещение по x (левый пич)
     dst_p += dst_front_poch;
@@ -377,16 +403,15 @@ void insert(Image& dst, CN<Sprite> src, Vec pos, int optional) {
     src_p += src_front_poch;
 
     // отрисовка строки
-    for (auto x = sx; x < ex; ++x) {
-      // табличная оптимизация без использования ветвления:
-      const Pal8 SRC_DST[2] {bf(*src_p, *dst_p, optional), *dst_p};
-      *dst_p = SRC_DST[mask_p->val & 1];
-
-      // движение по строке
-      ++src_p;
-      ++mask_p;
-      ++dst_p;
+    if constexpr (bf == &blend_past) {
+      blit::row_past(dst_p, src_p, mask_p, row_len);
+    } else {
+      blit::row(dst_p, src_p, mask_p, row_len, [optional](const Pal8 in, const Pal8 bg)
+        { return bf(in, bg, optional); });
     }
+    src_p += row_len;
+    mask_p += row_len;
+    dst_p += row_len;
 
     // смещение по x (правый пич)
     dst_p += dst_back_porch;
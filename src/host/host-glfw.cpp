@@ -7,6 +7,7 @@
 #include "host-util.hpp"
 #include "host-glfw.hpp"
 #include "host-glfw-keymap.hpp"
+#include "render-thread.hpp"
 #include "util/log.hpp"
 #include "util/str-util.hpp"
 #include "util/error.hpp"
@@ -18,6 +19,8 @@
 #include "game/core/debug.hpp"
 #include "game/core/core-window.hpp"
 #include "game/core/graphic.hpp"
+#include "game/core/canvas.hpp"
+#include "graphic/image/image.hpp"
 extern "C" {
   #include "ogl.hpp"
   #ifdef WINDOWS
@@ -88,7 +91,9 @@ Host_glfw::Host_glfw(int argc, char *argv[])
   iferror(instance, "no use two GLFW hosts");
   instance.store(this);
 
-  hpw::set_vsync = &host_glfw_set_vsync;
+  hpw::set_vsync = [this](bool enable) {
+    gl_call([enable]{ host_glfw_set_vsync(enable); });
+  };
   glfwSetErrorCallback(error_callback);
   detailed_log("init GLFW lib\n");
   iferror(!glfwInit(), "!glfwInit");
@@ -101,6 +106,7 @@ Host_glfw::Host_glfw(int argc, char *argv[])
 } // Host_glfw c-tor
 
 Host_glfw::~Host_glfw() {
+  stop_render_thread();
   glfwDestroyWindow(window);
   glfwTerminate();
   instance = {};
@@ -134,7 +140,9 @@ void Host_glfw::init() {
 void Host_glfw::run() {
   Host_ogl::run();
   init();
-  
+  if (graphic::render_thread)
+    start_render_thread();
+
   while (is_ran()) {
     auto gameloop_time_point_start = get_time();
 
@@ -148,6 +156,7 @@ void Host_glfw::run() {
     game_set_fps_info(gameloop_time);
   } // while is_ran
 
+  stop_render_thread();
   is_run = false;
 } // run
 
@@ -189,7 +198,12 @@ void Host_glfw::_set_fullscreen(bool enable) {
 void Host_glfw::_set_double_buffering(bool enable) {
   detailed_log("Host_glfw._set_double_buffering: " << enable << "\n");
   graphic::double_buffering = enable;
+  // окно пересоздаётся вместе с контекстом, поэтому поток рендера на это время выключается
+  cauto restart_render_thread = bool(m_render_thread);
+  stop_render_thread();
   init_window();
+  if (restart_render_thread)
+    start_render_thread();
 }
 
 void Host_glfw::set_gamma(const double gamma) {
@@ -306,8 +320,13 @@ void Host_glfw::game_frame(double dt) {
     if (!graphic::skip_cur_frame) { // не рисовать кадр при этом флаге
       calc_lerp_alpha();
       draw_game_frame();
-      draw();
-      glfwSwapBuffers(window);
+      if (m_render_thread) {
+        // вывод на экран и ожидание VSync пройдут в потоке рендера
+        m_render_thread->push(*graphic::canvas);
+      } else {
+        draw();
+        glfwSwapBuffers(window);
+      }
       frame_drawn = true;
       apply_render_delay();
       ++fps;
@@ -452,3 +471,42 @@ void Host_glfw::frame_wait() {
   delay = std::clamp<double>(delay, 0, delay_timeout);
   glfwWaitEventsTimeout(delay);
 }
+
+void Host_glfw::start_render_thread() {
+  return_if (m_render_thread);
+  detailed_log("start render thread\n");
+  glfwMakeContextCurrent(nullptr);
+  m_render_thread = new_unique<Render_thread>(graphic::canvas->X, graphic::canvas->Y,
+    [this](CN<Image> frame) {
+      ogl_draw(frame.data());
+      glfwSwapBuffers(window);
+    },
+    [this] { glfwMakeContextCurrent(window); },
+    [] { glfwMakeContextCurrent(nullptr); }
+  );
+
+  // палитра грузится в текстуру, поэтому тоже через поток рендера
+  m_palette_loader = hpw::init_palette_from_archive;
+  hpw::init_palette_from_archive = [this](const Str& fname) {
+    gl_call([this, &fname]{ m_palette_loader(fname); });
+  };
+} // start_render_thread
+
+void Host_glfw::stop_render_thread() {
+  return_if (!m_render_thread);
+  detailed_log("stop render thread\n");
+  m_render_thread = {};
+  hpw::init_palette_from_archive = m_palette_loader;
+  glfwMakeContextCurrent(window);
+}
+
+void Host_glfw::gl_call(CN<std::function<void ()>> action) {
+  if (m_render_thread)
+    m_render_thread->call(action);
+  else
+    action();
+}
+
+void Host_glfw::ogl_resize(int w, int h) {
+  gl_call([this, w, h]{ Host_ogl::ogl_resize(w, h); });
+}
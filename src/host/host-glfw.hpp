@@ -1,10 +1,12 @@
 #pragma once
+#include <functional>
 #include "host-ogl.hpp"
 #include "util/mem-types.hpp"
 #include "game/util/keybits.hpp"
 
 struct GLFWwindow;
 class Key_mapper;
+class Render_thread;
 
 /// рендерер от GLFW
 class Host_glfw: public Host_ogl {
@@ -29,6 +31,8 @@ protected:
   double update_time {};
   double start_update_time {}; /// нужен для интерполяции движения
   bool frame_drawn {false}; /// для плавного апдейта игры
+  Unique<Render_thread> m_render_thread {}; /// есть при graphic::render_thread
+  std::function<void (const Str&)> m_palette_loader {}; /// загрузчик палитры из Host_ogl
 
   void game_set_dt(double gameloop_time);
   void game_set_fps_info(double gameloop_time);
@@ -53,4 +57,11 @@ protected:
   /// определить какой кадр надо скипать
   void check_frame_skip();
   void frame_wait();
+  /// отдать OpenGL контекст потоку рендера
+  void start_render_thread();
+  /// вернуть OpenGL контекст главному потоку
+  void stop_render_thread();
+  /// выполнить action там, где сейчас OpenGL контекст
+  void gl_call(CN<std::function<void ()>> action);
+  void ogl_resize(int w, int h) override;
 }; // Host_glfw
@@ -0,0 +1,202 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <cstring>
+#include "host-headless.hpp"
+#include "host-util.hpp"
+#include "command.hpp"
+#include "util/log.hpp"
+#include "util/path.hpp"
+#include "util/error.hpp"
+#include "util/str-util.hpp"
+#include "util/platform.hpp"
+#include "util/math/mat.hpp"
+#include "game/core/core.hpp"
+#include "game/core/common.hpp"
+#include "game/core/canvas.hpp"
+#include "game/core/graphic.hpp"
+#include "game/core/palette.hpp"
+#include "game/core/debug.hpp"
+#include "game/core/replays.hpp"
+#include "game/util/sync.hpp"
+#include "game/util/keybits.hpp"
+#include "game/util/game-archive.hpp"
+#include "graphic/image/image.hpp"
+#include "graphic/image/image-io.hpp"
+#include "graphic/image/color-table.hpp"
+
+/** разбор аргументов:
+--ticks N       сделать N апдейтов и выйти
+--frame-step N  рисовать кадр раз в N апдейтов (0 - не рисовать)
+--replay path   брать ввод из реплея
+--dump dir      сохранять нарисованные кадры в PNG
+--expect hash   сравнить хэш состояния в конце реплея с ожидаемым */
+static Host_headless::Config parse_args(int argc, char *argv[]) {
+  Host_headless::Config ret;
+  for (int i = 1; i < argc; ++i) {
+    const Str arg = argv[i];
+    cont_if (arg == "--headless");
+    iferror(i + 1 >= argc, "headless: no value for argument \"" << arg << "\"");
+    const Str val = argv[++i];
+
+    if (arg == "--ticks")
+      ret.ticks = s2n<uint>(val);
+    else if (arg == "--frame-step")
+      ret.frame_step = s2n<uint>(val);
+    else if (arg == "--replay")
+      ret.replay = val;
+    else if (arg == "--dump")
+      ret.dump_dir = val;
+    else if (arg == "--expect")
+      ret.expect_hash = str_tolower(val);
+    else
+      error("headless: unknown argument \"" << arg << "\"");
+  }
+  return ret;
+} // parse_args
+
+bool is_headless_launch(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i)
+    return_if (std::strcmp(argv[i], "--headless") == 0, true);
+  return false;
+}
+
+Host_headless::Host_headless(int argc, char *argv[])
+: Protownd(argc, argv)
+, m_config {parse_args(argc, argv)}
+, m_start_time {std::chrono::steady_clock::now()}
+{
+  init_archive();
+  load_color_tables();
+  init_commands();
+  if ( !m_config.dump_dir.empty()) {
+    m_config.dump_dir += SEPARATOR;
+    conv_sep(m_config.dump_dir);
+    make_dir_if_not_exist(m_config.dump_dir);
+  }
+} // c-tor
+
+void Host_headless::init_commands() {
+  // ничего не ждать и не пропускать кадры
+  hpw::set_vsync = [](bool) {};
+  hpw::set_gamma = [this](const double val) { this->set_gamma(val); };
+  // палитра нужна только для сохранения кадров в PNG
+  hpw::init_palette_from_archive = [](CN<Str> fname) {
+    graphic::current_palette_file = fname;
+    try {
+      load_ogl_palette(fname);
+    } catch (...) {
+      hpw_log("не удалось загрузить файл палитры \"" << fname << "\"\n");
+      graphic::current_palette_file = {};
+    }
+  };
+} // init_commands
+
+void Host_headless::init() {
+  set_target_ups(hpw::target_ups);
+  hpw::safe_dt = hpw::target_update_time;
+  hpw::real_dt = hpw::target_update_time * std::max<uint>(m_config.frame_step, 1);
+  hpw::enable_update_profile = true;
+  hpw::update_profile = {};
+}
+
+void Host_headless::run() {
+  init();
+  hpw_log("headless: ticks " << m_config.ticks << ", frame step "
+    << m_config.frame_step << '\n');
+
+  cauto start = get_time();
+  uint ticks {};
+  while (is_run && (m_config.ticks == 0 || ticks < m_config.ticks)) {
+    game_update(hpw::target_update_time);
+    ++ticks;
+    if (m_config.frame_step != 0 && ticks % m_config.frame_step == 0)
+      game_frame();
+  }
+
+  is_run = false;
+  print_stat(get_time() - start, ticks);
+  check_replay_hash();
+} // run
+
+void Host_headless::game_update(double dt) {
+  hpw::any_key_pressed |= is_any_key_pressed();
+  cauto st = get_time();
+  update(dt);
+  hpw::update_time_unsafe = get_time() - st;
+  hpw::any_key_pressed = false;
+  keys_cur_to_prev();
+}
+
+void Host_headless::game_frame() {
+  // кадр рисуется сразу после апдейта, интерполировать нечего
+  graphic::lerp_alpha = 1;
+  graphic::effect_state = std::fmod(graphic::effect_state + hpw::real_dt, 1.0);
+  graphic::skip_cur_frame = false;
+  hpw::cur_upf = m_config.frame_step;
+  cauto st = get_time();
+  draw_game_frame();
+  graphic::hard_draw_time = get_time() - st;
+  ++graphic::frame_count;
+  ++m_frames;
+  if ( !m_config.dump_dir.empty())
+    dump_frame();
+}
+
+void Host_headless::dump_frame() const {
+  std::ostringstream name;
+  name << m_config.dump_dir << "frame_" << std::setw(6) << std::setfill('0')
+    << m_frames << ".png";
+  save(*graphic::canvas, name.str());
+}
+
+void Host_headless::print_stat(double elapsed, uint ticks) const {
+  cauto game_time = ticks * hpw::target_update_time;
+  std::cout << "headless: " << ticks << " ticks (" << n2s(game_time, 2)
+    << " s of game time), " << m_frames << " frames in " << n2s(elapsed, 3) << " s\n";
+  std::cout << "  ups: " << n2s(safe_div(ticks, elapsed), 1)
+    << ", fps: " << n2s(safe_div(m_frames, elapsed), 1)
+    << ", speed: x" << n2s(safe_div(game_time, elapsed), 2) << '\n';
+
+  cnauto prof = hpw::update_profile;
+  std::cout << "  update time (s): level " << n2s(prof.level, 3)
+    << ", entities " << n2s(prof.entities, 3)
+    << " (collisions " << n2s(prof.collisions, 3) << ")"
+    << ", hud " << n2s(prof.hud, 3)
+    << ", camera " << n2s(prof.camera, 3)
+    << ", effects " << n2s(prof.post_effects, 3) << std::endl;
+} // print_stat
+
+void Host_headless::check_replay_hash() {
+  return_if (m_config.replay.empty());
+  cauto hash = n2hex(hpw::replay_state_hash);
+  std::cout << "state hash: " << hash << std::endl;
+  // контрольные точки проверяются и без ожидаемого хэша
+  if (hpw::replay_desync_tick != 0) {
+    std::cout << "replay DESYNC: checkpoint at tick " << hpw::replay_desync_tick << std::endl;
+    m_exit_code = 1;
+  }
+  return_if (m_config.expect_hash.empty());
+
+  if (hash == m_config.expect_hash) {
+    std::cout << "replay OK" << std::endl;
+  } else {
+    std::cout << "replay DESYNC: expected " << m_config.expect_hash << std::endl;
+    m_exit_code = 1;
+  }
+} // check_replay_hash
+
+void Host_headless::update(double dt) {}
+
+double Host_headless::get_time() const {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start_time).count();
+}
+
+// окна нет, поэтому оконные настройки только запоминаются
+void Host_headless::ogl_resize(int w, int h) {}
+void Host_headless::_set_fullscreen(bool enable) { graphic::fullscreen = enable; }
+void Host_headless::_set_double_buffering(bool enable) { graphic::double_buffering = enable; }
+void Host_headless::_set_mouse_cursour_mode(bool enable) { graphic::show_mouse_cursour = enable; }
+void Host_headless::set_gamma(const double gamma) { graphic::gamma = std::clamp<double>(gamma, 0.025, 3); }
@@ -0,0 +1,53 @@
+#pragma once
+#include <chrono>
+#include "protownd.hpp"
+#include "util/str.hpp"
+#include "util/math/num-types.hpp"
+
+/** хост без окна и OpenGL.
+Игра обновляется с фиксированным dt без ожиданий и рисуется в graphic::canvas,
+поэтому годится для профилирования и прогонов на машине без GPU */
+class Host_headless: public Protownd {
+public:
+  /// параметры запуска, читаются из аргументов командной строки
+  struct Config {
+    uint ticks {}; /// сколько апдейтов сделать, 0 - пока игра сама не закончится
+    uint frame_step {4}; /// рисовать кадр раз в столько апдейтов, 0 - не рисовать
+    Str replay {}; /// путь до реплея, с которого брать ввод
+    Str dump_dir {}; /// куда сохранять кадры в PNG, пусто - не сохранять
+    Str expect_hash {}; /// ожидаемый хэш состояния в конце реплея (hex), пусто - не проверять
+  };
+
+  explicit Host_headless(int argc, char *argv[]);
+  ~Host_headless() = default;
+  void run() override;
+  inline CN<Config> get_config() const { return m_config; }
+  /// 0 - успех, 1 - реплей разошёлся с контрольной точкой или с ожидаемым хэшем
+  inline int get_exit_code() const { return m_exit_code; }
+
+protected:
+  virtual void update(double dt);
+  double get_time() const override;
+  void ogl_resize(int w, int h) override;
+  void _set_fullscreen(bool enable) override;
+  void _set_double_buffering(bool enable) override;
+  void _set_mouse_cursour_mode(bool enable) override;
+  void set_gamma(const double gamma) override;
+
+private:
+  Config m_config {};
+  std::chrono::steady_clock::time_point m_start_time {};
+  uint m_frames {}; /// сколько кадров нарисовано
+  int m_exit_code {};
+
+  void init();
+  void init_commands();
+  void game_update(double dt);
+  void game_frame();
+  void dump_frame() const;
+  void print_stat(double elapsed, uint ticks) const;
+  void check_replay_hash();
+}; // Host_headless
+
+/// есть ли среди аргументов --headless
+bool is_headless_launch(int argc, char *argv[]);
@@ -1,5 +1,7 @@
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include <cstdint>
 #include "host-ogl.hpp"
 #include "host-util.hpp"
 #include "command.hpp"
@@ -54,16 +56,18 @@ void Host_ogl::ogl_init() {
   glShadeModel(GL_FLAT); // не гладкая заливка
 
   glClearColor(0,0,0,0);
+  // при пересоздании окна старые объекты OpenGL умерли вместе с контекстом
+  pal_tex_ = 0;
   pal_tex_init();
   init_palette_loader();
   screen_tex_init();
+  upload_bufs_init();
 
   check_p(hpw::archive);
   compie_vertex_shader();
   compie_fragment_shader();
   compile_program();
 
-  init_screen_poly();
   ogl_resize(w_, h_);
 } // ogl_init
 
@@ -75,28 +79,31 @@ void Host_ogl::init_palette_loader() {
 }
 
 /// отрисовать кадр на текстуру
-void Host_ogl::ogl_draw() {
+void Host_ogl::ogl_draw(CP<void> pixels) {
   /* TODO пока не будут картинки по краям экрана, надо заливать чёрным,
   чтобы на линуксе не была эпилепсия */
   glClear(GL_COLOR_BUFFER_BIT);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, screen_tex_); // текстура для graphic::canvas
-  // перенос пикселей в текстуру
-  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w_, h_, GL_RED,
-    GL_UNSIGNED_BYTE, pixels_);
+  // перенос пикселей в текстуры
+  upload_frame(pixels ? pixels : pixels_);
 
   glActiveTexture(GL_TEXTURE1);
   glBindTexture(GL_TEXTURE_1D, pal_tex_); // текстура палитры
-
-  glBindVertexArray(vao_); // растягивание текстуры
   glUseProgram(shader_prog_); // применение шейдера
-  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4); // отрисовка текстуры на полигонах
+
+  glActiveTexture(GL_TEXTURE0);
+  for (cnauto tile: screen_tiles_) {
+    glBindTexture(GL_TEXTURE_2D, tile.tex); // текстура для части graphic::canvas
+    glBindVertexArray(tile.vao); // растягивание текстуры
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4); // отрисовка текстуры на полигонах
+  }
 
   glUseProgram(0);
-  glBindVertexArray(0); // unbind vao_
+  glBindVertexArray(0); // unbind vao
+  glActiveTexture(GL_TEXTURE1);
   glBindTexture(GL_TEXTURE_1D, 0); // unbind pal_tex_
-  glBindTexture(GL_TEXTURE_2D, 0); // unbind screen_tex_
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, 0); // unbind tile.tex
 
 #ifdef WINDOWS
   // stuttering fix
@@ -108,34 +115,93 @@ void Host_ogl::ogl_draw() {
     glFlush();
 } // ogl_draw
 
+void Host_ogl::upload_frame(CP<void> pixels) {
+  nauto buf = upload_bufs_[upload_buf_idx_];
+  upload_buf_idx_ = (upload_buf_idx_ + 1) % UPLOAD_BUFFERS;
+  const std::size_t frame_sz = w_ * h_;
+  bool from_pbo = true;
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf.pbo);
+
+  if (persistent_upload_) {
+    // дождаться, пока GPU дочитает этот буффер с прошлого круга
+    if (buf.fence) {
+      cauto fence = scast<GLsync>(buf.fence);
+      constexpr GLuint64 FENCE_TIMEOUT_NS = 1'000'000'000;
+      glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_NS);
+      glDeleteSync(fence);
+      buf.fence = {};
+    }
+    std::memcpy(buf.mapped, pixels, frame_sz);
+  } else {
+    // orphaning: GPU дочитывает старую память, а кадр пишется в новую
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, frame_sz, {}, GL_STREAM_DRAW);
+    auto dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, frame_sz,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst) {
+      std::memcpy(dst, pixels, frame_sz);
+      from_pbo = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+    } else {
+      from_pbo = false;
+    }
+    // если PBO не отобразился, то грузить как раньше, из памяти процесса
+    if ( !from_pbo)
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, w_);
+  glActiveTexture(GL_TEXTURE0);
+  for (cnauto tile: screen_tiles_) {
+    const std::uintptr_t offset = tile.y * w_ + tile.x;
+    // при привязанном PBO указатель - это смещение в нём
+    cauto src = from_pbo
+      ? reinterpret_cast<CP<void>>(offset)
+      : cptr2ptr<CP<void>>(cptr2ptr<CP<byte>>(pixels) + offset);
+    glBindTexture(GL_TEXTURE_2D, tile.tex);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tile.w, tile.h, GL_RED,
+      GL_UNSIGNED_BYTE, src);
+  }
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  if (persistent_upload_)
+    buf.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+} // upload_frame
+
 /// вызывается в конце инита наследника
 void Host_ogl::ogl_post_init() {
   ogl_init();
   reshape(window_ctx_.w, window_ctx_.h);
 }
 
-void Host_ogl::init_screen_poly() {
+void Host_ogl::init_tile_poly(Screen_tile& tile) {
+  // область тайла в координатах OpenGL
+  cauto left   = -1.f + 2.f * tile.x / w_;
+  cauto right  = -1.f + 2.f * (tile.x + tile.w) / w_;
+  cauto top    =  1.f - 2.f * tile.y / h_;
+  cauto bottom =  1.f - 2.f * (tile.y + tile.h) / h_;
   // квадрат из треугольников
   Vector<float> vertices{
-    -1,  1, 0, 0,
-    -1, -1, 0, 1,
-     1,  1, 1, 0,
-     1, -1, 1, 1
+    left,  top,    0, 0,
+    left,  bottom, 0, 1,
+    right, top,    1, 0,
+    right, bottom, 1, 1
   };
-  glGenBuffers(1, &vbo_);
-  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+  glGenBuffers(1, &tile.vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, tile.vbo);
   glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertices.size(),
     vertices.data(), GL_STATIC_DRAW);
 
   // Vertex layout
-  glGenVertexArrays(1, &vao_);
-  glBindVertexArray(vao_);
+  glGenVertexArrays(1, &tile.vao);
+  glBindVertexArray(tile.vao);
   glEnableVertexAttribArray(0);
   glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(float) * 4, {});
 
-  glBindVertexArray(0); // unbind vao_
-  glBindBuffer(GL_ARRAY_BUFFER, 0); // unbind vbo_
-} // init_screen_poly
+  glBindVertexArray(0); // unbind vao
+  glBindBuffer(GL_ARRAY_BUFFER, 0); // unbind vbo
+} // init_tile_poly
 
 void Host_ogl::compile_program() {
   shader_prog_ = glCreateProgram();
@@ -198,18 +264,74 @@ void Host_ogl::compie_fragment_shader() {
 } // compie_fragment_shader
 
 void Host_ogl::screen_tex_init() {
-  check_max_gltex_sz();
-  glGenTextures(1, &screen_tex_);
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, screen_tex_);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w_, h_, 0, GL_RGB, GL_FLOAT, {});
-  glBindTexture(GL_TEXTURE_2D, 0);  // unbind screen_tex_
+  // если canvas больше допустимой текстуры, то он режется на тайлы
+  cauto max_sz = check_max_gltex_sz();
+  screen_tiles_.clear();
+  for (int y = 0; y < h_; y += max_sz)
+  for (int x = 0; x < w_; x += max_sz) {
+    Screen_tile tile {.x = x, .y = y,
+      .w = std::min(max_sz, w_ - x), .h = std::min(max_sz, h_ - y)};
+    glGenTextures(1, &tile.tex);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tile.tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // индексы палитры по байту на пиксель, как в canvas
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, tile.w, tile.h, 0, GL_RED, GL_UNSIGNED_BYTE, {});
+    glBindTexture(GL_TEXTURE_2D, 0);  // unbind tile.tex
+    init_tile_poly(tile);
+    screen_tiles_.push_back(tile);
+  }
+  if (screen_tiles_.size() > 1)
+    detailed_log("canvas split into " << screen_tiles_.size() << " textures\n");
 } // scree_tex_init
 
+void Host_ogl::upload_bufs_init() {
+  const std::size_t frame_sz = w_ * h_;
+  const bool try_persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+  persistent_upload_ = try_persistent;
+  upload_buf_idx_ = 0;
+
+  for (nauto buf: upload_bufs_) {
+    buf = {};
+    glGenBuffers(1, &buf.pbo);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf.pbo);
+    if (try_persistent) {
+      constexpr GLbitfield FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER, frame_sz, {}, FLAGS);
+      buf.mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, frame_sz, FLAGS);
+      persistent_upload_ &= buf.mapped != nullptr;
+    } else {
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, frame_sz, {}, GL_STREAM_DRAW);
+    }
+  }
+
+  // без отображения остаётся путь для GL 3.3, но буфферы от glBufferStorage
+  // нельзя переразмечать через glBufferData, поэтому они пересоздаются
+  if (try_persistent && !persistent_upload_) {
+    hpw_log("не удалось отобразить PBO, загрузка кадра будет через orphaning\n");
+    for (nauto buf: upload_bufs_) {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf.pbo);
+      if (buf.mapped)
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      glDeleteBuffers(1, &buf.pbo);
+      buf = {};
+      glGenBuffers(1, &buf.pbo);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf.pbo);
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, frame_sz, {}, GL_STREAM_DRAW);
+    }
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  detailed_log("canvas upload: " << (persistent_upload_
+    ? "persistent mapped PBO" : "PBO orphaning") << '\n');
+} // upload_bufs_init
+
 void Host_ogl::pal_tex_init() {
-  glGenTextures(1, &pal_tex_);
+  // при смене палитры текстура перезаливается, а не создаётся заново
+  if (pal_tex_ == 0)
+    glGenTextures(1, &pal_tex_);
   glActiveTexture(GL_TEXTURE1);
   glBindTexture(GL_TEXTURE_1D, pal_tex_);
   // не делать линейным, иначе появятся розовые оттенки
@@ -231,16 +353,15 @@ void Host_ogl::pal_tex_init() {
     _gen_palette();
   }
   // в 1D текстуре хранятся триплеты палитры для шейдера
-  glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB, 256, 0, GL_RGB, GL_FLOAT, pal_rgb.data());
+  glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB8, 256, 0, GL_RGB, GL_FLOAT, pal_rgb.data());
   glBindTexture(GL_TEXTURE_1D, 0); // unbind pal_tex_
 } // pal_tex_init
 
-void Host_ogl::check_max_gltex_sz() {
-  auto max_canvas_sz = std::max(graphic::width, graphic::height);
+int Host_ogl::check_max_gltex_sz() {
   GLint avaliable_max_sz = -1;
   glGetIntegerv(GL_MAX_TEXTURE_SIZE, &avaliable_max_sz);
   detailed_log("max texture size: " << avaliable_max_sz << '\n');
-  // если эта ошибка выстрелит, то напиши разбивку на тайлы и их рендери
-  iferror(avaliable_max_sz < max_canvas_sz,
-    "GL_MAX_TEXTURE_SIZE < " << n2s(max_canvas_sz));
+  // большой canvas режется на тайлы, но совсем маленькие текстуры - это сломанный драйвер
+  iferror(avaliable_max_sz < 64, "GL_MAX_TEXTURE_SIZE < 64");
+  return avaliable_max_sz;
 }
@@ -10,26 +10,47 @@ public:
 
 protected:
   void ogl_post_init(); /// вызывается в конце инита наследника
-  void ogl_draw(); /// отрисовать кадр на текстуру
-  void check_max_gltex_sz();
+  /// отрисовать кадр на текстуру. pixels - кадр размером с graphic::canvas, пусто - сам canvas
+  void ogl_draw(CP<void> pixels = {});
+  /// @return GL_MAX_TEXTURE_SIZE
+  int check_max_gltex_sz();
   virtual void draw(); /// draw от main_f внутри execute
+  /// растягивает OpenGL полотно
+  void ogl_resize(int w, int h) override;
 
 private:
-  uint screen_tex_ = 0; /// OpenGL текстура экрана
-  uint vao_ = 0, vbo_ = 0;
+  /// часть canvas в своей текстуре. Больше одной, если canvas не влезает в GL_MAX_TEXTURE_SIZE
+  struct Screen_tile {
+    int x {}, y {}, w {}, h {}; /// область canvas
+    uint tex {};
+    uint vao {}, vbo {};
+  };
+  /// PBO для загрузки кадра в текстуру без ожидания драйвера
+  struct Upload_buffer {
+    uint pbo {};
+    void* mapped {}; /// постоянное отображение при GL 4.4, иначе nullptr
+    void* fence {}; /// GLsync загрузки из этого буффера, пока GPU её не дочитал
+  };
+  constx uint UPLOAD_BUFFERS = 3;
+
+  Vector<Screen_tile> screen_tiles_ {};
+  Upload_buffer upload_bufs_[UPLOAD_BUFFERS] {};
+  uint upload_buf_idx_ {};
+  bool persistent_upload_ {}; /// есть glBufferStorage (GL 4.4)
   uint shader_prog_ = 0, vert_shader_ = 0, frag_shader_ = 0;
   uint pal_tex_ = 0;
   CP<void> pixels_ {}; /// данные для копирования в текстуру
 
-  /// растягивает OpenGL полотно
-  void ogl_resize(int w, int h) override;
   /// настройка индексированной палитры
   void ogl_init();
-  void init_screen_poly();
+  void init_tile_poly(Screen_tile& tile);
   void compile_program();
   void compie_vertex_shader();
   void compie_fragment_shader();
   void pal_tex_init();
   void screen_tex_init();
+  void upload_bufs_init();
+  /// скопировать кадр в следующий PBO и обновить из него текстуры
+  void upload_frame(CP<void> pixels);
   void init_palette_loader();
 }; // Host_ogl
@@ -0,0 +1,156 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+#include "render-thread.hpp"
+#include "util/vector-types.hpp"
+#include "graphic/image/image.hpp"
+
+struct Render_thread::Impl {
+  Present m_present {};
+  Context_switch m_attach {};
+  Context_switch m_detach {};
+  std::thread m_thread {};
+  std::mutex m_mutex {};
+  std::condition_variable m_cv {};
+  /// кадры переходят между потоками, поэтому счётчик атомарный
+  Shared_mt<Image> m_pending {}; /// последний отданный кадр
+  Shared_mt<Image> m_drawing {}; /// кадр, который сейчас выводится
+  bool m_has_pending {};
+  bool m_stop {};
+  /// исключение при выводе кадра, перебрасывается в следующий push или call
+  std::exception_ptr m_present_error {};
+  /// действие из call. Живёт на стеке вызвавшего, пока он ждёт
+  struct Job {
+    const Action* action {};
+    std::exception_ptr error {}; /// исключение действия, перебрасывается в call
+    bool done {};
+  };
+  Vector<Job*> m_jobs {}; /// что выполнить в потоке рендера
+  std::atomic_uint m_presented {};
+
+  inline Impl(int frame_x, int frame_y, CN<Present> present,
+  CN<Context_switch> attach, CN<Context_switch> detach)
+  : m_present {present}
+  , m_attach {attach}
+  , m_detach {detach}
+  , m_pending {new_shared_mt<Image>(frame_x, frame_y)}
+  , m_drawing {new_shared_mt<Image>(frame_x, frame_y)}
+  {
+    assert(m_present);
+    assert(m_attach);
+    assert(m_detach);
+    m_thread = std::thread([this]{ loop(); });
+  }
+
+  inline ~Impl() {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable())
+      m_thread.join();
+  }
+
+  /// перебросить ошибку вывода кадра в главный поток. Вызывать под m_mutex
+  inline void rethrow_present_error() {
+    return_if ( !m_present_error);
+    auto error = std::exchange(m_present_error, {});
+    std::rethrow_exception(error);
+  }
+
+  inline void push(CN<Image> frame) {
+    {
+      std::lock_guard lock(m_mutex);
+      rethrow_present_error();
+      assert(frame.size == m_pending->size);
+      std::copy(frame.begin(), frame.end(), m_pending->begin());
+      m_has_pending = true;
+    }
+    m_cv.notify_all();
+  }
+
+  inline void call(CN<Action> action) {
+    assert(action);
+    if (std::this_thread::get_id() == m_thread.get_id()) {
+      action();
+      return;
+    }
+
+    Job job {.action = &action};
+    {
+      std::unique_lock lock(m_mutex);
+      rethrow_present_error();
+      m_jobs.push_back(&job);
+      m_cv.notify_all();
+      m_cv.wait(lock, [&]{ return job.done; });
+    }
+    // ошибку потока рендера получает тот, кто ждал действие
+    if (job.error)
+      std::rethrow_exception(job.error);
+  }
+
+  inline void loop() {
+    m_attach();
+    std::unique_lock lock(m_mutex);
+
+    while (true) {
+      m_cv.wait(lock, [this]{ return m_stop || m_has_pending || !m_jobs.empty(); });
+
+      // сначала команды главного потока, он их ждёт
+      if ( !m_jobs.empty()) {
+        auto jobs = std::move(m_jobs);
+        m_jobs = {};
+        lock.unlock();
+        for (auto job: jobs) {
+          try {
+            (*job->action)();
+          } catch (...) {
+            job->error = std::current_exception();
+          }
+        }
+        lock.lock();
+        for (auto job: jobs)
+          job->done = true;
+        m_cv.notify_all();
+        continue;
+      }
+
+      if (m_has_pending) {
+        // забрать кадр, пока главный поток рисует следующий
+        m_pending.swap(m_drawing);
+        m_has_pending = false;
+        lock.unlock();
+        std::exception_ptr error {};
+        try {
+          m_present(*m_drawing);
+          ++m_presented;
+        } catch (...) {
+          error = std::current_exception();
+        }
+        lock.lock();
+        if (error)
+          m_present_error = error;
+        continue;
+      }
+
+      break_if (m_stop);
+    } // while
+
+    lock.unlock();
+    m_detach();
+  } // loop
+}; // Impl
+
+Render_thread::Render_thread(int frame_x, int frame_y, CN<Present> present,
+CN<Context_switch> attach, CN<Context_switch> detach)
+: impl {new_unique<Impl>(frame_x, frame_y, present, attach, detach)} {}
+Render_thread::~Render_thread() {}
+void Render_thread::push(CN<Image> frame) { impl->push(frame); }
+void Render_thread::call(CN<Action> action) { impl->call(action); }
+uint Render_thread::get_presented() const { return impl->m_presented; }
@@ -0,0 +1,40 @@
+#pragma once
+#include <functional>
+#include "util/macro.hpp"
+#include "util/mem-types.hpp"
+#include "util/math/num-types.hpp"
+
+class Image;
+
+/** поток вывода кадров на экран.
+Главный поток рисует кадр в graphic::canvas и отдаёт копию через push,
+а этот поток загружает её в OpenGL и ждёт VSync, пока игра обновляется дальше.
+Софтверная отрисовка кадра остаётся в главном потоке.
+OpenGL контекст всё это время принадлежит потоку рендера */
+class Render_thread final {
+  nocopy(Render_thread);
+  struct Impl;
+  Unique<Impl> impl {};
+
+public:
+  /// вывести кадр на экран, вызывается в потоке рендера
+  using Present = std::function<void (CN<Image> frame)>;
+  /// сделать OpenGL контекст текущим в вызвавшем потоке или отпустить его
+  using Context_switch = std::function<void ()>;
+  using Action = std::function<void ()>;
+
+  /// @param frame_x, frame_y размеры кадра, буфферы выделяются один раз
+  explicit Render_thread(int frame_x, int frame_y, CN<Present> present,
+    CN<Context_switch> attach, CN<Context_switch> detach);
+  /// дорисовывает последний кадр, останавливает поток и отпускает контекст
+  ~Render_thread();
+  /** отдать готовый кадр.
+  Если прошлый кадр ещё не начали выводить, он заменяется новым.
+  Ошибка вывода прошлого кадра перебрасывается отсюда */
+  void push(CN<Image> frame);
+  /** выполнить action с OpenGL контекстом в потоке рендера и дождаться конца.
+  Исключение из action или из вывода прошлого кадра перебрасывается сюда */
+  void call(CN<Action> action);
+  /// сколько кадров выведено на экран
+  uint get_presented() const;
+}; // Render_thread
@@ -1,66 +1,241 @@
-extern "C" {
-#include <zip/zip.h>
-}
-#include <fstream>
+#define MINIZ_HEADER_FILE_ONLY // реализация miniz собирается в zip.c
+#include <zip/miniz.h>
+#include <cassert>
+#include <cstring>
+#include <unordered_map>
 #include "archive.hpp"
 #include "util/log.hpp"
 #include "util/error.hpp"
 #include "util/str-util.hpp"
 #include "util/file/file.hpp"
 
+#ifdef LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef WINDOWS
+#define NOMINMAX
+#include <windows.h>
+#endif
+
 File::File(CN<Bytes> _data, CN<Str> _path)
 : Resource {_path}
 , data {_data}
 {}
 
+/// архив, отображённый в память, и его оглавление
+struct Archive::Impl {
+  /// где в архиве лежит файл
+  struct Entry {
+    std::size_t offset {}; /// начало данных файла
+    std::size_t packed_size {};
+    std::size_t size {}; /// размер после распаковки
+    std::uint32_t crc {};
+    std::uint16_t method {}; /// 0 - без сжатия, 8 - deflate
+  };
+
+  CP<byte> m_data {};
+  std::size_t m_size {};
+  std::unordered_map<Str, Entry> m_index {};
+  Strs m_names {}; /// имена в порядке оглавления
+#ifdef LINUX
+  int m_fd {-1};
+#elif defined(WINDOWS)
+  HANDLE m_file {INVALID_HANDLE_VALUE};
+  HANDLE m_mapping {};
+#else
+  Bytes m_buf {}; /// без отображения файл просто читается в память
+#endif
+
+  inline explicit Impl(CN<Str> fname) {
+    map_file(fname);
+    read_index(fname);
+  }
+
+  inline ~Impl() {
+#ifdef LINUX
+    if (m_data)
+      ::munmap(ccast<byte*>(m_data), m_size);
+    if (m_fd >= 0)
+      ::close(m_fd);
+#elif defined(WINDOWS)
+    if (m_data)
+      ::UnmapViewOfFile(m_data);
+    if (m_mapping)
+      ::CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+      ::CloseHandle(m_file);
+#endif
+  }
+
+  inline void map_file(CN<Str> fname) {
+#ifdef LINUX
+    m_fd = ::open(fname.c_str(), O_RDONLY);
+    iferror(m_fd < 0, "Archive: file \"" << fname << "\" not opened");
+    struct ::stat st {};
+    iferror(::fstat(m_fd, &st) != 0, "Archive: fstat error \"" << fname << "\"");
+    m_size = st.st_size;
+    iferror(m_size == 0, "Archive: file \"" << fname << "\" is empty");
+    auto mapped = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    iferror(mapped == MAP_FAILED, "Archive: mmap error \"" << fname << "\"");
+    m_data = scast<CP<byte>>(mapped);
+#elif defined(WINDOWS)
+    m_file = ::CreateFileA(fname.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    iferror(m_file == INVALID_HANDLE_VALUE, "Archive: file \"" << fname << "\" not opened");
+    LARGE_INTEGER file_size {};
+    iferror( !::GetFileSizeEx(m_file, &file_size), "Archive: GetFileSizeEx error \"" << fname << "\"");
+    m_size = file_size.QuadPart;
+    iferror(m_size == 0, "Archive: file \"" << fname << "\" is empty");
+    m_mapping = ::CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    iferror( !m_mapping, "Archive: CreateFileMapping error \"" << fname << "\"");
+    m_data = scast<CP<byte>>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    iferror( !m_data, "Archive: MapViewOfFile error \"" << fname << "\"");
+#else
+    m_buf = mem_from_file(fname);
+    m_data = m_buf.data();
+    m_size = m_buf.size();
+#endif
+  } // map_file
+
+  inline std::uint16_t u16(std::size_t pos) const {
+    return m_data[pos] | (m_data[pos + 1] << 8);
+  }
+
+  inline std::uint32_t u32(std::size_t pos) const {
+    return u16(pos) | (std::uint32_t(u16(pos + 2)) << 16);
+  }
+
+  /// читает центральный каталог zip (end of central directory -> записи)
+  inline void read_index(CN<Str> fname) {
+    constexpr std::uint32_t EOCD_SIGN = 0x06054b50;
+    constexpr std::uint32_t CD_SIGN = 0x02014b50;
+    constexpr std::uint32_t LOCAL_SIGN = 0x04034b50;
+    constexpr std::size_t EOCD_SIZE = 22;
+    constexpr std::size_t CD_SIZE = 46;
+    constexpr std::size_t LOCAL_SIZE = 30;
+
+    // EOCD в конце файла, после него может быть комментарий до 64 Кб
+    iferror(m_size < EOCD_SIZE, "Archive: \"" << fname << "\" is not zip");
+    std::size_t eocd = m_size - EOCD_SIZE;
+    cauto eocd_min = m_size > EOCD_SIZE + 0xFFFF ? m_size - EOCD_SIZE - 0xFFFF : 0;
+    while (u32(eocd) != EOCD_SIGN) {
+      iferror(eocd == eocd_min, "Archive: \"" << fname << "\" end of central directory not found");
+      --eocd;
+    }
+
+    cauto count = u16(eocd + 10);
+    cauto cd_size = u32(eocd + 12);
+    std::size_t pos = u32(eocd + 16);
+    iferror(count == 0xFFFF || pos == 0xFFFFFFFFu, "Archive: zip64 in \"" << fname << "\" is not supported");
+    iferror(pos + cd_size > eocd, "Archive: \"" << fname << "\" bad central directory");
+
+    m_index.reserve(count);
+    m_names.reserve(count);
+    cfor (i, count) {
+      iferror(pos + CD_SIZE > eocd || u32(pos) != CD_SIGN,
+        "Archive: \"" << fname << "\" bad central directory entry " << i);
+      Entry entry;
+      entry.method = u16(pos + 10);
+      entry.crc = u32(pos + 16);
+      entry.packed_size = u32(pos + 20);
+      entry.size = u32(pos + 24);
+      cauto name_len = u16(pos + 28);
+      cauto extra_len = u16(pos + 30);
+      cauto comment_len = u16(pos + 32);
+      cauto local = u32(pos + 42);
+      // имя и хвост записи тоже должны быть внутри каталога
+      iferror(pos + CD_SIZE + name_len + extra_len + comment_len > eocd,
+        "Archive: \"" << fname << "\" central directory entry " << i << " out of directory");
+      Str name(cptr2ptr<CP<char>>(m_data + pos + CD_SIZE), name_len);
+      pos += CD_SIZE + name_len + extra_len + comment_len;
+
+      // данные идут после локального заголовка, у него своя длина extra
+      iferror(local + LOCAL_SIZE > m_size || u32(local) != LOCAL_SIGN,
+        "Archive: \"" << fname << "\" bad local header for \"" << name << "\"");
+      entry.offset = local + LOCAL_SIZE + u16(local + 26) + u16(local + 28);
+      iferror(entry.offset + entry.packed_size > m_size,
+        "Archive: \"" << fname << "\" data of \"" << name << "\" out of file");
+
+      m_names.push_back(name);
+      m_index.emplace(std::move(name), entry);
+    }
+  } // read_index
+
+  inline CN<Entry> find(CN<Str> fname) const {
+    auto it = m_index.find(fname);
+    iferror(it == m_index.end(), "Archive: file \"" + fname + "\" not found");
+    return it->second;
+  }
+
+  /// распаковка не трогает общее состояние, поэтому можно из разных потоков
+  inline std::span<const byte> view(CN<Str> fname, CN<Entry> entry, Bytes& buf) const {
+    cauto src = m_data + entry.offset;
+    if (entry.method == 0) { // stored
+      iferror(entry.packed_size != entry.size, "Archive: bad size of \"" << fname << "\"");
+      iferror(mz_crc32(MZ_CRC32_INIT, src, entry.size) != entry.crc,
+        "Archive: CRC error in \"" << fname << "\"");
+      return {src, entry.size};
+    }
+    iferror(entry.method != 8, "Archive: compression method " << entry.method
+      << " of \"" << fname << "\" is not supported");
+
+    buf.resize(entry.size);
+    cauto unpacked = tinfl_decompress_mem_to_mem(buf.data(), buf.size(),
+      src, entry.packed_size, TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+    iferror(unpacked != entry.size, "Archive: \"" << fname << "\" not unpacked");
+    iferror(mz_crc32(MZ_CRC32_INIT, buf.data(), buf.size()) != entry.crc,
+      "Archive: CRC error in \"" << fname << "\"");
+    return {buf.data(), buf.size()};
+  }
+}; // Impl
+
+/// приводит имя к виду, как в оглавлении zip
+inline static void fix_name(Str& fname) {
+  replace_all(fname, "\\", "/");
+  replace_all(fname, "//", "/");
+  delete_all(fname, "./");
+}
+
 Archive::Archive(Str fname) {
   conv_sep(fname);
   detailed_log("Archive: load \"" << fname << "\"\n");
-  strm_buf = mem_from_file(fname);
-  zip = zip_stream_open(cptr2ptr<Cstr>(strm_buf.data()),
-    strm_buf.size(), 0, 'r');
-  iferror( !zip, "Archive.c-tor: zip error");
+  impl = new_unique<Impl>(fname);
 }
 
-Archive::~Archive() { zip_close(zip); }
+Archive::~Archive() {}
 
 File Archive::get_file(Str fname) const {
-  replace_all(fname, "\\", "/");
-  replace_all(fname, "//", "/");
-  delete_all(fname, "./");
+  fix_name(fname);
   detailed_log("Archive.get_file:\"" << fname << "\"\n");
-  _zip_check(zip_entry_open(zip, fname.c_str()),
-    "Archive.get_file: zip_entry_open \"" + fname + "\"");
-  auto out_size = zip_entry_size(zip);
-  if (out_size < 1) {
+  cnauto entry = impl->find(fname);
+  if (entry.size < 1) {
     hpw_log("Archive.get_file: file \"" + fname + "\" is empty\n");
     return {};
   }
-  File ret (Bytes(out_size), fname);
-  _zip_check(zip_entry_noallocread(zip, ret.data.data(), ret.data.size()),
-    "Archive.get_file: zip_entry_noallocread");
-  _zip_check(zip_entry_close(zip), "Archive.get_file: zip_entry_close");
+
+  Bytes buf;
+  cauto data = impl->view(fname, entry, buf);
+  File ret({}, fname);
+  // распакованное можно не копировать
+  if (data.data() == buf.data())
+    ret.data = std::move(buf);
+  else
+    ret.data.assign(data.begin(), data.end());
   return ret;
 } // get_file
 
-Strs Archive::get_all_names() const {
-  Strs ret;
-  int idx = 0;
-  int errcode;
-  while (true) {
-    errcode = zip_entry_openbyindex(zip, idx); 
-    if (errcode == ZIP_EINVIDX) {
-      _zip_check(zip_entry_close(zip), "Archive.get_all_names: zip_entry_close");
-      break;
-    }
-    _zip_check(errcode, "Archive.get_all_names: zip_entry_openbyindex");
-    ret.push_back(zip_entry_name(zip));
-    _zip_check(zip_entry_close(zip), "Archive.get_all_names: zip_entry_close");
-    ++idx;
-  }
-  return ret;
-} // get_all_names
+std::span<const byte> Archive::get_view(Str fname, Bytes& buf) const {
+  fix_name(fname);
+  detailed_log("Archive.get_view:\"" << fname << "\"\n");
+  return impl->view(fname, impl->find(fname), buf);
+}
 
-void Archive::_zip_check(int errcode, CN<Str> fname) const {
-  iferror(errcode < 0, fname << ":" << zip_strerror(errcode));
+bool Archive::has_file(Str fname) const {
+  fix_name(fname);
+  return impl->m_index.contains(fname);
 }
+
+Strs Archive::get_all_names() const { return impl->m_names; }
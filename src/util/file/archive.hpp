@@ -1,24 +1,30 @@
 #pragma once
+#include <span>
 #include "game/util/resource.hpp"
 #include "util/macro.hpp"
+#include "util/mem-types.hpp"
 #include "util/str-util.hpp"
 #include "util/file/file.hpp"
 
-struct zip_t;
-
-/// для работы с архива типа .zip
+/** для работы с архива типа .zip.
+Файл архива отображается в память, оглавление читается один раз в c-tor.
+После создания архив только читается, поэтому get_file/get_view
+можно вызывать из разных потоков */
 class Archive final: public Resource {
-  zip_t *zip {};
-  Bytes strm_buf {};
-
-  void _find_name_rec(CN<Str> fname, Strs& dst) const;
-  void _zip_check(int errcode, CN<Str> fname) const;
+  struct Impl;
+  Unique<Impl> impl {};
 
 public:
   explicit Archive(Str fname);
   ~Archive();
   /// получить файл из архива в виде RAW данных
   File get_file(Str fname) const;
+  /** получить данные файла без лишнего копирования.
+  Несжатый файл отдаётся прямо из памяти архива, сжатый распаковывается в buf
+  @return данные файла. Живут, пока живы архив и buf */
+  std::span<const byte> get_view(Str fname, Bytes& buf) const;
+  /// есть ли файл в архиве
+  bool has_file(Str fname) const;
   /// все имена файлов в архиве
   Strs get_all_names() const;
 }; // Archive
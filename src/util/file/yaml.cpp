@@ -122,6 +122,12 @@ public:
     self = YAML::Load({file.data.begin(), file.data.end()});
   }
 
+  inline Impl(std::span<const byte> mem, CN<Str> path)
+  : Resource(path) {
+    detailed_log("Yaml: loading from view \"" << path << "\"\n");
+    self = YAML::Load(std::string(mem.begin(), mem.end()));
+  }
+
   inline Impl(CN<Yaml> other) { this->operator=(other); }
   inline Impl(Yaml&& other) { this->operator=(std::move(other)); }
 
@@ -235,6 +241,12 @@ Yaml::Yaml(CN<File> file)
   Resource::operator=(*impl);
 }
 
+Yaml::Yaml(std::span<const byte> mem, CN<Str> path)
+: impl {new_unique<Impl>(mem, path)}
+{
+  Resource::operator=(*impl);
+}
+
 Yaml::Yaml(Yaml&& other) noexcept
 : impl {new_unique<Impl>(other)}
 {
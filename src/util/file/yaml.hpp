@@ -1,4 +1,5 @@
 #pragma once
+#include <span>
 #include "game/util/resource.hpp"
 #include "util/unicode.hpp"
 #include "util/mem-types.hpp"
@@ -16,6 +17,8 @@ public:
   Yaml(Str fname, bool make_if_not_exist=false);
   /// загрузить .yml из памяти файла
   Yaml(CN<File> file);
+  /// загрузить .yml из памяти без копии в File (например из Archive::get_view)
+  Yaml(std::span<const byte> mem, CN<Str> path);
   Yaml(CN<Impl> new_impl);
   Yaml();
   ~Yaml();
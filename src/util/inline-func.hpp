@@ -0,0 +1,96 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include "util/macro.hpp"
+
+template <class Sig, std::size_t SZ> class Inline_func;
+
+/** замена std::function, которая хранит функтор внутри себя и никогда не выделяет память.
+Функтор должен влезать в SZ байт (см. fits), иначе ошибка компиляции. Не копируется, только перемещается */
+template <class Ret, class... Args, std::size_t SZ>
+class Inline_func<Ret (Args...), SZ> final {
+  using Invoke = Ret (*)(void* self, Args... args);
+  /// src != nullptr - переместить src в dst и удалить src, иначе удалить dst
+  using Manage = void (*)(void* dst, void* src);
+
+  /// выравнивание под указатели и double, без паддинга до max_align_t
+  constx std::size_t ALIGN = std::max(alignof(void*), alignof(double));
+  alignas(ALIGN) std::byte m_data[SZ];
+  Invoke m_invoke {};
+  Manage m_manage {}; /// nullptr - функтор можно копировать побайтно
+
+  inline void reset() noexcept {
+    if (m_manage)
+      m_manage(m_data, nullptr);
+    m_invoke = {};
+    m_manage = {};
+  }
+
+  inline void move_from(Inline_func& other) noexcept {
+    m_invoke = other.m_invoke;
+    m_manage = other.m_manage;
+    if (m_manage)
+      m_manage(m_data, other.m_data);
+    else if (m_invoke)
+      std::memcpy(m_data, other.m_data, SZ);
+    other.m_invoke = {};
+    other.m_manage = {};
+  }
+
+public:
+  constx std::size_t capacity = SZ;
+  /// F влезает в буффер. Иначе конструктора из F нет и сборка падает на вызове
+  template <class F>
+  constx bool fits = sizeof(F) <= SZ && alignof(F) <= ALIGN
+    && std::is_nothrow_move_constructible_v<F>;
+
+  Inline_func() noexcept = default;
+  inline Inline_func(std::nullptr_t) noexcept {}
+  inline ~Inline_func() { reset(); }
+  Inline_func(CN<Inline_func> other) = delete;
+  Inline_func& operator =(CN<Inline_func> other) = delete;
+  inline Inline_func(Inline_func&& other) noexcept { move_from(other); }
+
+  inline Inline_func& operator =(Inline_func&& other) noexcept {
+    if (this != &other) {
+      reset();
+      move_from(other);
+    }
+    return *this;
+  }
+
+  template <class F>
+  requires (!std::is_same_v<std::decay_t<F>, Inline_func>
+    && std::is_invocable_r_v<Ret, std::decay_t<F>&, Args...>
+    && fits<std::decay_t<F>>)
+  inline Inline_func(F&& func) {
+    using Func = std::decay_t<F>;
+
+    if constexpr (std::is_pointer_v<Func>)
+      return_if ( !func);
+    new (m_data) Func(std::forward<F>(func));
+    m_invoke = [](void* self, Args... args)->Ret
+      { return (*std::launder(scast<Func*>(self)))(std::forward<Args>(args)...); };
+    if constexpr ( !std::is_trivially_copyable_v<Func>) {
+      m_manage = [](void* dst, void* src) {
+        if (src) {
+          auto src_func = std::launder(scast<Func*>(src));
+          new (dst) Func(std::move(*src_func));
+          std::destroy_at(src_func);
+        } else {
+          std::destroy_at(std::launder(scast<Func*>(dst)));
+        }
+      };
+    }
+  } // c-tor
+
+  inline Ret operator()(Args... args) const {
+    return m_invoke(const_cast<std::byte*>(m_data), std::forward<Args>(args)...);
+  }
+
+  inline explicit operator bool() const noexcept { return m_invoke != nullptr; }
+}; // Inline_func
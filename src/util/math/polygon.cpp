@@ -11,6 +11,35 @@
 #include "game/core/debug.hpp"
 #endif
 
+/** точки полигона со смещением для gjk. Мелкие полигоны
+лежат на стеке, поэтому проверка не трогает аллокатор */
+class Offset_points final {
+  nocopy(Offset_points);
+  constx std::size_t STACK_POINTS = 16;
+  vec2 m_stack[STACK_POINTS];
+  Vector<vec2> m_heap {};
+  CP<vec2> m_data {};
+  std::size_t m_size {};
+
+public:
+  inline explicit Offset_points(CN<Polygon> poly, const Vec offset)
+  : m_size {poly.points.size()} {
+    vec2* dst = m_stack;
+    if (m_size > STACK_POINTS) {
+      m_heap.resize(m_size);
+      dst = m_heap.data();
+    }
+    cfor (i, m_size) {
+      cnauto point = poly.points[i];
+      dst[i] = vec2 {.x = point.x + offset.x, .y = point.y + offset.y};
+    }
+    m_data = dst;
+  }
+
+  inline CP<vec2> data() const { return m_data; }
+  inline std::size_t size() const { return m_size; }
+}; // Offset_points
+
 bool Polygon::collided_with(const Vec this_center, const Vec other_center,
 CN<Polygon> other) const {
   // сами себя не проверяем
@@ -18,24 +47,15 @@ CN<Polygon> other) const {
     return false;
 
   // добавить смещения
-	auto this_offset = offset + this_center;
-  auto this_poly = *this;
-  for (nauto point: this_poly.points)
-    point += this_offset;
-
-	auto other_offset = other.offset + other_center;
-  auto other_poly = other;
-  for (nauto point: other_poly.points)
-    point += other_offset;
+  const Offset_points this_points(*this, offset + this_center);
+  const Offset_points other_points(other, other.offset + other_center);
 
   #ifdef CLD_DEBUG
   ++hpw::poly_checks;
   #endif
 
-  static_assert(sizeof(vec2) == sizeof(Vec));
-  return gjk (
-    cptr2ptr<CP<vec2>>(this_poly.points.data()), this_poly.points.size(),
-    cptr2ptr<CP<vec2>>(other_poly.points.data()), other_poly.points.size() );
+  return gjk(this_points.data(), this_points.size(),
+    other_points.data(), other_points.size());
 } // collided_with
 
 bool Polygon::operator ==(CN<Polygon> other) const {
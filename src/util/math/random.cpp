@@ -1,5 +1,7 @@
 #include <cassert>
-#include <random>
+#include <cstdlib>
+#include <atomic>
+#include <type_traits>
 #include "rand-table-256.hpp"
 #include "random.hpp"
 #include "game/core/debug.hpp"
@@ -10,16 +12,43 @@
 #endif
 
 namespace {
-  inline uint32_t seed {1};
-  inline uint32_t rndr_fast_rpng {1};
-  inline uint32_t rnd_fast_lcg_state {1};
-  inline uint32_t rndu_fast_lcg_state {1};
-  inline uint32_t rndb_lcg_state {1};
-  inline auto rnd_gen {std::minstd_rand()};
-  inline auto rndu_gen {std::minstd_rand()};
-  inline auto rndr_gen {std::minstd_rand()};
-  inline uint8_t table_idx {0};
-}
+  inline std::atomic_uint32_t seed {1};
+  /** стабильные генераторы - счётчики Rnd_stream, сдвигаются атомарно без блокировок.
+  Порядок значений зависит от порядка вызовов, поэтому в параллельном коде
+  лучше брать свой Rnd_stream */
+  inline std::atomic_uint64_t rnd_state {};
+  inline std::atomic_uint64_t rndu_state {};
+  inline std::atomic_uint64_t rndr_state {};
+  inline std::atomic_uint64_t rndb_state {};
+  /// номер следующего потока, для разных сидов быстрых генераторов
+  inline std::atomic_uint32_t fast_thread_count {};
+
+  /** быстрые генераторы для графики, у каждого потока свои.
+  Конструктор тривиальный, а thread_local инициализируется константой,
+  поэтому обращение к fast_state не проходит через проверку инициализации TLS.
+  Сид ставится при первом вызове в потоке */
+  struct Fast_rnd_state {
+    uint32_t rndr_rpng;
+    uint32_t rnd_lcg;
+    uint32_t rndu_lcg;
+    uint8_t table_idx;
+    bool seeded;
+
+    inline void reseed(uint32_t new_seed) {
+      if (new_seed == 0)
+        new_seed = 97'997u;
+      rndr_rpng = new_seed;
+      rnd_lcg = new_seed;
+      rndu_lcg = new_seed;
+      table_idx = uint8_t(new_seed);
+      seeded = true;
+    }
+  };
+  static_assert(std::is_trivially_default_constructible_v<Fast_rnd_state>);
+  static_assert(std::is_trivially_destructible_v<Fast_rnd_state>);
+
+  constinit thread_local Fast_rnd_state fast_state {};
+} // namespace
 
 /// узнаёт, можно ли вызывать эту функцию при hpw::allow_random_stable
 inline void check_safe_random() {
@@ -29,9 +58,15 @@ inline void check_safe_random() {
   #endif
 }
 
+/// состояние быстрых генераторов текущего потока
+inline Fast_rnd_state& fast() {
+  if ( !fast_state.seeded) [[unlikely]]
+    fast_state.reseed(seed + fast_thread_count++ * 7'919u);
+  return fast_state;
+}
 
 inline CN<uint8_t> table_rndb() {
-  return rand_table_256[table_idx++];
+  return rand_table_256[fast().table_idx++];
 }
 
 inline uint RPNG(uint32_t& state) {
@@ -56,14 +91,39 @@ inline uint32_t lcg_parkmiller(uint32_t& state) {
   return state = result;
 }
 
+/// сдвинуть общий счётчик и получить 64 бита
+inline uint64_t next_stable(std::atomic_uint64_t& state) {
+  return rnd_mix64(state.fetch_add(Rnd_stream::GAMMA, std::memory_order_relaxed)
+    + Rnd_stream::GAMMA);
+}
+
+// перевод 64 случайных бит в нужный диапазон, общий для Rnd_stream и стабильных функций
+
+inline int32_t bits_to_i32(const uint64_t bits, const int32_t rmin, const int32_t rmax) {
+  if (rmin >= rmax)
+    return rmin;
+  const uint64_t range = uint64_t(int64_t(rmax) - int64_t(rmin)) + 1u;
+  return int32_t(int64_t(rmin) + int64_t(bits % range));
+}
+
+inline uint32_t bits_to_u32(const uint64_t bits, const uint32_t rmax) {
+  if (rmax == 0)
+    return 0;
+  return uint32_t(bits % (uint64_t(rmax) + 1u));
+}
+
+inline real bits_to_real(const uint64_t bits, const real rmin, const real rmax) {
+  if (rmin >= rmax)
+    return rmin;
+  // старшие 24 бита влезают в мантиссу float без округления
+  const real t = real(bits >> 40) * real(1.0 / 16'777'216.0);
+  return rmin + (rmax - rmin) * t;
+}
+
 /// прогрев генераторов
 inline void init_generators() {
   ALLOW_STABLE_RAND
   cfor (_, 10u) {
-    do_not_optimize(rndb());
-    do_not_optimize(rnd());
-    do_not_optimize(rndu());
-    do_not_optimize(rndr());
     do_not_optimize(rndb_fast());
     do_not_optimize(rnd_fast());
     do_not_optimize(rndu_fast());
@@ -72,77 +132,62 @@ inline void init_generators() {
 }
 
 void set_rnd_seed(uint32_t new_seed) {
-  #pragma omp critical(rnd_seed_section)
-  {
-    if (new_seed == 0)
-      new_seed = 97'997u;
-    seed = new_seed;
-    srand(seed);
-    rndr_fast_rpng = new_seed;
-    rnd_fast_lcg_state = seed;
-    rndu_fast_lcg_state = seed;
-    rndb_lcg_state = seed;
-    rnd_gen.seed(seed);
-    rndr_gen.seed(seed);
-    rndu_gen.seed(seed);
-    table_idx = uint8_t(seed);
-  } // omp critical
-
+  if (new_seed == 0)
+    new_seed = 97'997u;
+  seed = new_seed;
+  srand(new_seed);
+  rnd_state = Rnd_stream(new_seed, 0).get_state();
+  rndu_state = Rnd_stream(new_seed, 1).get_state();
+  rndr_state = Rnd_stream(new_seed, 2).get_state();
+  rndb_state = Rnd_stream(new_seed, 3).get_state();
+  fast_state.reseed(new_seed);
   init_generators();
 }
 
 uint8_t rndb() {
   check_safe_random();
-  uint8_t ret;
-  #pragma omp critical(rndb_section)
-  { ret = lcg_parkmiller(rndb_lcg_state); }
-  return ret;
+  return next_stable(rndb_state) >> 56;
 }
 
 int32_t rnd(int32_t rmin, int32_t rmax) {
   check_safe_random();
-  if (rmin >= rmax)
-    return rmin;
-  std::uniform_int_distribution<int32_t> dist(rmin, rmax);
-  int32_t ret;
-  #pragma omp critical(rnd_section)
-  { ret = dist(rnd_gen); }
-  return ret;
+  return bits_to_i32(next_stable(rnd_state), rmin, rmax);
 }
 
 uint32_t rndu(uint32_t rmax) {
   check_safe_random();
-  if (rmax == 0)
-    return 0;
-  std::uniform_int_distribution<uint32_t> dist(0, rmax);
-  uint32_t ret;
-  #pragma omp critical(rndu_section)
-  { ret = dist(rndu_gen); }
-  return ret;
+  return bits_to_u32(next_stable(rndu_state), rmax);
 }
 
 real rndr(real rmin, real rmax) {
   check_safe_random();
-  if (rmin >= rmax)
-    return rmin;
-  std::uniform_real_distribution<real> dist(rmin, rmax);
-  real ret;
-  #pragma omp critical(rndr_section)
-  { ret = dist(rndr_gen); }
-  return ret;
+  return bits_to_real(next_stable(rndr_state), rmin, rmax);
 }
 
-uint32_t get_rnd_seed() {
-  uint32_t ret;
-  #pragma omp critical(rnd_seed_section)
-  { ret = seed; }
+uint32_t get_rnd_seed() { return seed; }
+
+uint64_t rnd_state_hash() {
+  uint64_t ret = get_rnd_seed();
+  ret = ret * 31 + rnd_state;
+  ret = ret * 31 + rndu_state;
+  ret = ret * 31 + rndr_state;
+  ret = ret * 31 + rndb_state;
   return ret;
 }
 
+Rnd_stream make_rnd_stream(uint64_t stream_id) {
+  // первые номера заняты стабильными генераторами
+  return Rnd_stream(get_rnd_seed(), stream_id + 4u);
+}
+
+int32_t Rnd_stream::rnd(int32_t rmin, int32_t rmax) { return bits_to_i32(next(), rmin, rmax); }
+uint32_t Rnd_stream::rndu(uint32_t rmax) { return bits_to_u32(next(), rmax); }
+real Rnd_stream::rndr(real rmin, real rmax) { return bits_to_real(next(), rmin, rmax); }
+
 uint8_t rndb_fast() { return table_rndb(); }
-int32_t rnd_fast() { return lcg_parkmiller(rnd_fast_lcg_state); }
-uint32_t rndu_fast() { return lcg_parkmiller(rndu_fast_lcg_state); }
-real rndr_fast() { return RPNG(rndr_fast_rpng) * real(1.0 / 32767.0); }
+int32_t rnd_fast() { return lcg_parkmiller(fast().rnd_lcg); }
+uint32_t rndu_fast() { return lcg_parkmiller(fast().rndu_lcg); }
+real rndr_fast() { return RPNG(fast().rndr_rpng) * real(1.0 / 32767.0); }
 
 int32_t rnd_fast(int32_t rmin, int32_t rmax) {
   return (rnd_fast() % (rmax + std::abs(rmin) + 1)) - std::abs(rmin);
@@ -6,6 +6,8 @@
 
 void set_rnd_seed(uint32_t new_seed);
 uint32_t get_rnd_seed();
+/// хэш состояния стабильных генераторов (rnd, rndu, rndr, rndb), сами генераторы не сдвигает
+uint64_t rnd_state_hash();
 /// random byte
 uint8_t rndb();
 uint8_t rndb_fast();
@@ -21,3 +23,54 @@ uint32_t rndu_fast();
 real rndr(real rmin=0, real rmax=1);
 real rndr_fast(real rmin, real rmax);
 real rndr_fast();
+
+/// перемешивание 64 бит (финализатор SplitMix64)
+constexpr uint64_t rnd_mix64(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xBF58'476D'1CE4'E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D0'49BB'1331'11EBull;
+  return x ^ (x >> 31);
+}
+
+/** детерминированный поток случайных чисел без блокировок.
+Состояние - один 64-битный счётчик (SplitMix64), поэтому поток можно копировать,
+сохранять в реплей или снапшот и восстанавливать через get_state/set_state.
+Каждый объект, которому нужен рандом при параллельном апдейте, держит свой поток */
+class Rnd_stream final {
+public:
+  constx uint64_t GAMMA = 0x9E37'79B9'7F4A'7C15ull; /// шаг счётчика
+
+  Rnd_stream() = default;
+  /// независимые потоки для одного сида различаются stream_id
+  constexpr explicit Rnd_stream(uint64_t seed, uint64_t stream_id=0)
+  : m_state { rnd_mix64(seed) ^ rnd_mix64(stream_id + GAMMA) } {}
+
+  /// сырые 64 бита
+  constexpr uint64_t next() {
+    m_state += GAMMA;
+    return rnd_mix64(m_state);
+  }
+
+  /// random byte
+  inline uint8_t rndb() { return next() >> 56; }
+  /// random i32 [rmin, rmax]
+  int32_t rnd(int32_t rmin=num_min<int32_t>(), int32_t rmax=num_max<int32_t>());
+  /// random u32 [0, rmax]
+  uint32_t rndu(uint32_t rmax=num_max<uint32_t>());
+  /// random real [rmin, rmax)
+  real rndr(real rmin=0, real rmax=1);
+  /// отделить новый независимый поток, этот при этом сдвигается
+  inline Rnd_stream split() {
+    cauto seed = next(); // порядок вычисления аргументов не задан, поэтому отдельно
+    return Rnd_stream(seed, next());
+  }
+
+  inline uint64_t get_state() const { return m_state; }
+  inline void set_state(uint64_t state) { m_state = state; }
+  inline bool operator ==(CN<Rnd_stream> other) const = default;
+
+private:
+  uint64_t m_state {};
+}; // Rnd_stream
+
+/// поток, который однозначно задаётся текущим сидом (get_rnd_seed) и номером
+Rnd_stream make_rnd_stream(uint64_t stream_id);
@@ -75,6 +75,8 @@ real rand_degree_stable() { return rndr(0, 360); }
 
 Vec rand_normalized_graphic() { return deg_to_vec(rand_degree_graphic()); }
 Vec rand_normalized_stable() { return deg_to_vec(rand_degree_stable()); }
+real rand_degree(Rnd_stream& rnd) { return rnd.rndr(0, 360); }
+Vec rand_normalized(Rnd_stream& rnd) { return deg_to_vec(rand_degree(rnd)); }
 
 Vec rotate_rad(const Vec center, const Vec src, real radian) {
   auto cos_mul = cos(radian);
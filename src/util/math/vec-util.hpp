@@ -7,6 +7,7 @@
 #endif
 
 struct Vec;
+class Rnd_stream;
 
 Vec rotate_rad(const Vec center, const Vec src, real radian);
 Vec rotate_deg(const Vec center, const Vec src, real degree);
@@ -44,6 +45,10 @@ real rand_degree_stable();
 Vec rand_normalized_graphic();
 /// случайный единичный вектор c защитой рандома
 Vec rand_normalized_stable();
+/// случайный угол из своего потока, можно звать из параллельного кода
+real rand_degree(Rnd_stream& rnd);
+/// случайный единичный вектор из своего потока
+Vec rand_normalized(Rnd_stream& rnd);
 
 real distance(const Vec a, const Vec b);
 real fast_distance(const Vec a, const Vec b);
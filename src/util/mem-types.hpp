@@ -1,5 +1,120 @@
 #pragma once
 #include <memory>
+#include <utility>
+
+#ifdef SHARED_THREAD_CHECK
+#include <cassert>
+#include <omp.h>
+#endif
+
+/* Shared/Weak - однопоточные (счётчик ссылок не атомарный).
+В omp-регионах их можно только создавать и перемещать. Копировать, удалять
+и lock'ать - под omp critical с ALLOW_SHARED_IN_THREAD, а в горячих параллельных
+циклах брать Borrow - заимствованную ссылку без счётчика.
+Объекты, которые живут в нескольких потоках сразу (кадры для потока рендера),
+держатся в Shared_mt/Weak_mt с атомарным счётчиком.
+При SHARED_THREAD_CHECK трогание Shared из не главного потока OMP ловится assert'ом */
+
+#ifdef SHARED_THREAD_CHECK
+/// счётчик разрешений трогать Shared из потоков OMP (см. ALLOW_SHARED_IN_THREAD)
+inline thread_local int shared_in_thread_allowed {0};
+
+/// Shared трогается из потока, где это разрешено
+inline void check_shared_thread() {
+  assert((omp_get_thread_num() == 0 || shared_in_thread_allowed > 0)
+    && "однопоточный Shared трогается из потока OMP, нужен omp critical или Borrow");
+}
+
+/// разрешить трогать Shared в этой области. Ставить только внутри omp critical
+struct Shared_in_thread_scope final {
+  inline Shared_in_thread_scope() { ++shared_in_thread_allowed; }
+  inline ~Shared_in_thread_scope() { --shared_in_thread_allowed; }
+  Shared_in_thread_scope(const Shared_in_thread_scope&) = delete;
+  Shared_in_thread_scope& operator =(const Shared_in_thread_scope&) = delete;
+};
+#define ALLOW_SHARED_IN_THREAD Shared_in_thread_scope shared_in_thread_scope {};
+
+template <class T> class Weak;
+
+/// однопоточный Shared с проверкой потока при изменении счётчика ссылок
+template <class T>
+class Shared: public std::__shared_ptr<T, __gnu_cxx::_S_single> {
+  using Base = std::__shared_ptr<T, __gnu_cxx::_S_single>;
+  inline void check() const { if (this->use_count() > 0) check_shared_thread(); }
+
+public:
+  using Base::Base;
+  Shared() = default;
+  inline Shared(const Shared& other) noexcept: Base(other) { check(); }
+  inline Shared(Shared&& other) noexcept = default;
+  inline Shared(const Base& other) noexcept: Base(other) { check(); }
+  inline Shared(Base&& other) noexcept: Base(std::move(other)) {}
+  template <class Y>
+  inline Shared(const Shared<Y>& other) noexcept: Base(other) { check(); }
+  template <class Y>
+  inline Shared(Shared<Y>&& other) noexcept: Base(std::move(other)) {}
+  inline ~Shared() { check(); }
+
+  inline Shared& operator =(const Shared& other) noexcept {
+    check();
+    other.check();
+    Base::operator =(other);
+    return *this;
+  }
+  inline Shared& operator =(Shared&& other) noexcept {
+    check();
+    Base::operator =(std::move(other));
+    return *this;
+  }
+}; // Shared
+
+/// однопоточный Weak с проверкой потока при изменении счётчика ссылок
+template <class T>
+class Weak: public std::__weak_ptr<T, __gnu_cxx::_S_single> {
+  using Base = std::__weak_ptr<T, __gnu_cxx::_S_single>;
+  /// у пустого Weak нет счётчика, у Weak на удалённый объект - есть
+  inline void check() const {
+    if (this->owner_before(Base{}) || Base{}.owner_before(*this))
+      check_shared_thread();
+  }
+
+public:
+  using Base::Base;
+  Weak() = default;
+  inline Weak(const Weak& other) noexcept: Base(other) { check(); }
+  inline Weak(Weak&& other) noexcept = default;
+  template <class Y>
+  inline Weak(const Shared<Y>& other) noexcept: Base(other) { check(); }
+  inline ~Weak() { check(); }
+
+  inline Weak& operator =(const Weak& other) noexcept {
+    check();
+    other.check();
+    Base::operator =(other);
+    return *this;
+  }
+  inline Weak& operator =(Weak&& other) noexcept {
+    check();
+    Base::operator =(std::move(other));
+    return *this;
+  }
+  template <class Y>
+  inline Weak& operator =(const Shared<Y>& other) noexcept {
+    check();
+    if (other)
+      check_shared_thread();
+    Base::operator =(other);
+    return *this;
+  }
+
+  inline Shared<T> lock() const noexcept {
+    check();
+    return Shared<T>(Base::lock());
+  }
+}; // Weak
+
+#else
+#define ALLOW_SHARED_IN_THREAD
 
 template <class T>
 using Shared = std::__shared_ptr<T, __gnu_cxx::_S_single>;
@@ -8,12 +123,60 @@ using Shared = std::__shared_ptr<T, __gnu_cxx::_S_single>;
 template <class T>
 using Weak = std::__weak_ptr<T, __gnu_cxx::_S_single>;
 //using Weak = std::weak_ptr<T>; clang
+#endif // SHARED_THREAD_CHECK
+
+/// Shared для объектов, которые копируются и удаляются из разных потоков
+template <class T>
+using Shared_mt = std::__shared_ptr<T, __gnu_cxx::_S_atomic>;
+
+template <class T>
+using Weak_mt = std::__weak_ptr<T, __gnu_cxx::_S_atomic>;
 
 template <class T>
 using Unique = std::unique_ptr<T>;
 
+/** заимствованная ссылка: не владеет объектом и не трогает счётчик ссылок.
+Владелец должен пережить её, поэтому берётся в главном потоке перед omp-циклом */
+template <class T>
+class Borrow final {
+  T* m_ptr {};
+
+public:
+  Borrow() = default;
+  inline explicit Borrow(T* ptr) noexcept: m_ptr {ptr} {}
+  template <class Y, __gnu_cxx::_Lock_policy Lp>
+  inline explicit Borrow(const std::__shared_ptr<Y, Lp>& src) noexcept: m_ptr {src.get()} {}
+  template <class Y>
+  inline Borrow(const Borrow<Y>& other) noexcept: m_ptr {other.get()} {}
+
+  inline T* get() const noexcept { return m_ptr; }
+  inline T* operator->() const noexcept { return m_ptr; }
+  inline T& operator*() const noexcept { return *m_ptr; }
+  inline explicit operator bool() const noexcept { return m_ptr != nullptr; }
+  inline bool operator ==(const Borrow& other) const noexcept = default;
+}; // Borrow
+
+/// заимствовать объект у Shared, счётчик не трогается
+template <class T, __gnu_cxx::_Lock_policy Lp>
+Borrow<T> borrow(const std::__shared_ptr<T, Lp>& src) noexcept { return Borrow<T>(src); }
+
+/** заимствовать объект у Weak. Тут нужен lock, поэтому вызывать в главном потоке.
+Пустой Borrow, если объект уже удалён */
+template <class T, __gnu_cxx::_Lock_policy Lp>
+Borrow<T> borrow(const std::__weak_ptr<T, Lp>& src) noexcept {
+#ifdef SHARED_THREAD_CHECK
+  if constexpr (Lp == __gnu_cxx::_S_single)
+    check_shared_thread();
+#endif
+  return Borrow<T>(src.lock());
+}
+
 template <class T, typename... Args>
 Shared<T> new_shared(Args&&... args) { return Shared<T>(new T(args...)); }
 
+template <class T, typename... Args>
+Shared_mt<T> new_shared_mt(Args&&... args)
+  { return std::__make_shared<T, __gnu_cxx::_S_atomic>(std::forward<Args>(args)...); }
+
 template <class T, typename... Args>
 Unique<T> new_unique(Args&&... args) { return Unique<T>(new T(args...)); }
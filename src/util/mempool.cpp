@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "mempool.hpp"
 
 #ifndef ECOMEM
@@ -11,23 +12,102 @@
   #endif
 #endif
 
-Mem_pool::Mem_pool(std::size_t chunk_sz)
+Mem_pool::Mem_pool([[maybe_unused]] std::size_t chunk_sz)
 #ifndef ECOMEM
-: source(chunk_sz)
+: m_chunk_sz {chunk_sz}
 #endif
 {}
 
+#ifndef ECOMEM
+Pool_slot* Mem_pool::allocate_slot(std::size_t obj_sz) {
+  // размер объекта округляется до выравнивания, ячейки одного размера в одном классе
+  cauto obj_units = (obj_sz + SLOT_ALIGN - 1) / SLOT_ALIGN;
+  cauto slot_sz = sizeof(Pool_slot) + obj_units * SLOT_ALIGN;
+  cauto class_idx = slot_sz / SLOT_ALIGN;
+  if (m_classes.size() <= class_idx)
+    m_classes.resize(class_idx + 1);
+  nauto cls = m_classes[class_idx];
+  cls.slot_sz = slot_sz;
+
+  Pool_slot* slot;
+  if (cls.free_list) { // сначала переиспользовать удалённые
+    slot = cls.free_list;
+    cls.free_list = slot->next_free;
+  } else {
+    // текущий слаб кончился - перейти на следующий, оставшийся после release
+    if (cls.cur_slab < cls.slabs.size() && cls.cur_slot >= cls.slabs[cls.cur_slab].slots) {
+      ++cls.cur_slab;
+      cls.cur_slot = 0;
+    }
+    // новый слаб, если старых не хватило
+    if (cls.cur_slab >= cls.slabs.size()) {
+      cauto slots = std::max(m_chunk_sz / slot_sz, MIN_SLAB_SLOTS);
+      // нули в заголовках - свободные ячейки нулевого поколения
+      cls.slabs.emplace_back(Slab {
+        .data = Unique<std::byte[]>(new std::byte[slots * slot_sz] {}),
+        .slots = slots
+      });
+      m_reserved += slots * slot_sz;
+      cls.cur_slab = cls.slabs.size() - 1;
+      cls.cur_slot = 0;
+    }
+    slot = ptr2ptr<Pool_slot*>(cls.slabs[cls.cur_slab].data.get() + cls.cur_slot * slot_sz);
+    ++cls.cur_slot;
+  }
+
+  slot->destroy = {};
+  slot->next_free = {};
+  slot->size_class = class_idx;
+  add_used_bytes(slot_sz);
+  return slot;
+} // allocate_slot
+
+void Mem_pool::free_slot(Pool_slot* slot) {
+  assert(slot);
+  nauto cls = m_classes.at(slot->size_class);
+  slot->destroy = {};
+  ++slot->generation;
+  slot->next_free = cls.free_list;
+  cls.free_list = slot;
+  sub_used_bytes(cls.slot_sz);
+}
+#endif
+
 void Mem_pool::release() {
 #ifndef ECOMEM
-  for (cnauto deleter: deleters)
-    deleter();
-  deleters.clear();
-  source.release();
+  // удалить живые объекты по всем выданным ячейкам
+  for (nauto cls: m_classes) {
+    cfor (slab_idx, cls.slabs.size()) {
+      break_if (slab_idx > cls.cur_slab);
+      nauto slab = cls.slabs[slab_idx];
+      cauto used = slab_idx == cls.cur_slab ? cls.cur_slot : slab.slots;
+      cfor (slot_idx, used) {
+        auto slot = ptr2ptr<Pool_slot*>(slab.data.get() + slot_idx * cls.slot_sz);
+        cont_if ( !slot->destroy);
+        slot->destroy(slot->object());
+        slot->destroy = {};
+        ++slot->generation;
+        sub_used_bytes(cls.slot_sz);
+      }
+    }
+    // слабы остаются и выдаются заново с начала
+    cls.free_list = {};
+    cls.cur_slab = 0;
+    cls.cur_slot = 0;
+  }
 #endif
 
   m_allocated = 0;
 }
 
+std::size_t Mem_pool::reserved() const {
+#ifndef ECOMEM
+  return m_reserved;
+#else
+  return m_allocated;
+#endif
+}
+
 Mem_pool::~Mem_pool() {
 #ifndef ECOMEM
   release();
@@ -35,7 +115,7 @@ Mem_pool::~Mem_pool() {
 #endif
 }
 
-void Mem_pool::add_used_bytes(std::size_t sz) {
+void Mem_pool::add_used_bytes([[maybe_unused]] std::size_t sz) {
 #ifndef ECOMEM
 #ifdef DETAILED_LOG
   mem_pool_cur_bytes_used += sz;
@@ -47,7 +127,7 @@ void Mem_pool::add_used_bytes(std::size_t sz) {
 #endif
 }
 
-void Mem_pool::sub_used_bytes(std::size_t sz) {
+void Mem_pool::sub_used_bytes([[maybe_unused]] std::size_t sz) {
 #ifndef ECOMEM
 #ifdef DETAILED_LOG
   mem_pool_cur_bytes_used -= sz;
@@ -64,4 +144,3 @@ void Mem_pool::print_used_bytes() {
 #endif
 #endif
 }
-
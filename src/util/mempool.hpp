@@ -1,12 +1,9 @@
 #pragma once
-
-#ifndef ECOMEM
-#include <memory_resource>
-#include <functional>
-#endif
-
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <utility>
+#include <cassert>
 #include "util/mem-types.hpp"
 #include "util/vector-types.hpp"
 #include "util/macro.hpp"
@@ -15,10 +12,47 @@
   #define Pool_ptr(T) Shared<T>
 
 #else
-  /// заглушка за место Shared
+  /// заголовок ячейки слаба, сразу за ним лежит объект
+  struct alignas(std::max_align_t) Pool_slot final {
+    using Destroy = void (*)(void* obj);
+
+    Destroy destroy {}; /// деструктор объекта, nullptr - ячейка свободна
+    Pool_slot* next_free {}; /// следующая свободная ячейка того же размера
+    std::uint32_t generation {}; /// растёт при каждом освобождении ячейки
+    std::uint32_t size_class {};
+    std::uint32_t obj_sz {}; /// sizeof объекта, который создан в ячейке
+
+    inline void* object() { return this + 1; }
+    inline static Pool_slot* from_object(void* obj) { return ptr2ptr<Pool_slot*>(obj) - 1; }
+  };
+
+  /** заглушка за место Shared, копируется как обычный указатель.
+  Помнит ячейку объекта, поэтому Pool_ptr на базовый класс удаляет
+  производный объект целиком, как type-erased deleter у unique_ptr.
+  В DEBUG хранит поколение ячейки и ловит обращение к освобождённому объекту */
   template <class T>
   class _Pool_ptr final {
+    template <class T2> friend class _Pool_ptr;
     T* ptr {};
+    Pool_slot* slot {}; /// nullptr - указатель не из Mem_pool::new_object
+  #ifdef DEBUG
+    std::uint32_t generation {};
+
+    inline void check() const {
+      assert(( !slot || slot->generation == generation)
+        && "объект из Mem_pool уже удалён");
+    }
+  #else
+    inline void check() const {}
+  #endif
+
+    inline void clear() noexcept {
+      ptr = {};
+      slot = {};
+    #ifdef DEBUG
+      generation = {};
+    #endif
+    }
 
   public:
     _Pool_ptr() = default;
@@ -28,67 +62,141 @@
     inline _Pool_ptr(T2* other) noexcept
     : ptr {other} {}
 
+    /// указатель на только что выделенный объект в ячейке slot
+    inline _Pool_ptr(T* other, [[maybe_unused]] Pool_slot* _slot) noexcept
+    : ptr {other}
+    , slot {_slot}
+  #ifdef DEBUG
+    , generation {_slot->generation}
+  #endif
+    {}
+
     template <class T2>
-    inline _Pool_ptr* operator =(CN<_Pool_ptr<T2>> other) noexcept
-    { ptr = other.get(); return this; }
+    inline _Pool_ptr& operator =(CN<_Pool_ptr<T2>> other) noexcept {
+      ptr = other.ptr;
+      slot = other.slot;
+    #ifdef DEBUG
+      generation = other.generation;
+    #endif
+      return *this;
+    }
 
     template <class T2>
-    inline _Pool_ptr* operator =(_Pool_ptr<T2>&& other) noexcept
-    { ptr = other.get(); other = {}; return this; }
+    inline _Pool_ptr& operator =(_Pool_ptr<T2>&& other) noexcept {
+      operator =(std::as_const(other));
+      other.clear();
+      return *this;
+    }
 
     template <class T2>
     inline _Pool_ptr(CN<_Pool_ptr<T2>> other) noexcept
-    : ptr {other.get()} {}
+    : ptr {other.ptr}
+    , slot {other.slot}
+  #ifdef DEBUG
+    , generation {other.generation}
+  #endif
+    {}
 
     template <class T2>
     inline _Pool_ptr(_Pool_ptr<T2>&& other) noexcept
-    : ptr {other.get()}
-    { other = {}; }
+    : _Pool_ptr(std::as_const(other))
+    { other.clear(); }
 
-    inline T* get() const { return ptr; }
-    inline T* operator->() const { return ptr; }
-    inline T& operator*() const { return *ptr; }
+    inline T* get() const { check(); return ptr; }
+    inline Pool_slot* get_slot() const { check(); return slot; }
+    inline T* operator->() const { check(); return ptr; }
+    inline T& operator*() const { check(); return *ptr; }
     inline operator bool() const { return scast<bool>(ptr); }
   }; // _Pool_ptr
 
-  #define Pool_ptr(T) _Pool_ptr<T> 
+  #define Pool_ptr(T) _Pool_ptr<T>
 #endif
 
+/** пул объектов. Без ECOMEM это слабы с ячейками одного размера и
+списками свободных ячеек на каждый размер: удалённые объекты переиспользуются,
+а release оставляет память себе, поэтому пул не растёт больше пикового числа объектов */
 class Mem_pool {
   void add_used_bytes(std::size_t sz);
   void sub_used_bytes(std::size_t sz);
   void print_used_bytes();
   std::size_t m_allocated {};
 
-public:
-  #ifndef ECOMEM
-  std::pmr::monotonic_buffer_resource source {};
-  Vector<std::function<void ()>> deleters {};
-  #endif
+#ifndef ECOMEM
+  /// кусок памяти под ячейки одного размера
+  struct Slab {
+    Unique<std::byte[]> data {};
+    std::size_t slots {};
+  };
+
+  /// ячейки одного размера
+  struct Size_class {
+    std::size_t slot_sz {}; /// заголовок + объект
+    Vector<Slab> slabs {};
+    std::size_t cur_slab {}; /// слаб, из которого выдаются новые ячейки
+    std::size_t cur_slot {}; /// первая ещё не выданная ячейка в cur_slab
+    Pool_slot* free_list {};
+  };
+
+  constx std::size_t SLOT_ALIGN = alignof(Pool_slot);
+  constx std::size_t MIN_SLAB_SLOTS = 8;
+  std::size_t m_chunk_sz {};
+  std::size_t m_reserved {};
+  Vector<Size_class> m_classes {}; /// индекс - размер ячейки в SLOT_ALIGN
+
+  Pool_slot* allocate_slot(std::size_t obj_sz);
+  void free_slot(Pool_slot* slot);
+#endif
 
+public:
   explicit Mem_pool(std::size_t chunk_sz = 256*256);
   ~Mem_pool();
+  /// удалить все объекты. Память остаётся в пуле для новых объектов
   void release();
+  /// байт под живыми объектами
   inline std::size_t allocated() const { return m_allocated; }
+  /// байт, взятых пулом у системы
+  std::size_t reserved() const;
 
   template <class T, typename... Args>
   inline Pool_ptr(T) new_object(Args&&... args) {
     m_allocated += sizeof(T);
 
     #ifdef ECOMEM
-      auto ret = new_shared<T>(std::forward<Args>(args)...);
+      return new_shared<T>(std::forward<Args>(args)...);
+    #else
+      static_assert(alignof(T) <= SLOT_ALIGN);
+      auto slot = allocate_slot(sizeof(T));
+      T* ret;
+      try {
+        ret = new (slot->object()) T(std::forward<Args>(args)...);
+      } catch (...) {
+        free_slot(slot);
+        m_allocated -= sizeof(T);
+        throw;
+      }
+      // обычный указатель на функцию вместо std::function
+      slot->destroy = [](void* obj) { std::destroy_at(scast<T*>(obj)); };
+      slot->obj_sz = sizeof(T);
+      return Pool_ptr(T)(ret, slot);
+    #endif
+  }
+
+  /// удалить объект раньше release, его ячейка пойдёт под новые объекты
+  template <class T>
+  inline void delete_object(Pool_ptr(T)& obj) {
+    return_if ( !obj);
+
+    #ifdef ECOMEM
+      m_allocated -= sizeof(T);
     #else
-      std::pmr::polymorphic_allocator<T> pa {&source};
-      auto ret = pa.template new_object<T>(std::forward<Args>(args)...);
-      add_used_bytes(sizeof(T));
-
-      // чтобы деструктор вызывался корректно
-      deleters.emplace_back ( [this, ret] {
-        std::pmr::polymorphic_allocator<T> pa {&source};
-        pa.delete_object(ret);
-        sub_used_bytes(sizeof(T));
-      } );
+      // T может быть базой: размер и начало объекта берутся из ячейки
+      auto slot = obj.get_slot();
+      assert(slot && "delete_object для указателя не из new_object");
+      assert(slot->destroy);
+      m_allocated -= slot->obj_sz;
+      slot->destroy(slot->object());
+      free_slot(slot);
     #endif
-    return ret;
+    obj = {};
   }
 }; // Mem_pool
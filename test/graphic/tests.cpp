@@ -186,9 +186,9 @@ inline void sprite_check() {
   // тест вставки. По середине спрайта красный, снизу справа белый
   dummy = Sprite(3, 3);
   dummy.get_image()->set(1, 1, Pal8::red, {});
-  dummy.get_mask()->set(1, 1, Pal8::mask_visible, {});
+  dummy.edit_mask()->set(1, 1, Pal8::mask_visible, {});
   dummy.get_image()->set(2, 2, Pal8::white, {});
-  dummy.get_mask()->set(2, 2, Pal8::mask_visible, {});
+  dummy.edit_mask()->set(2, 2, Pal8::mask_visible, {});
   Image for_insert(5, 5, Pal8::gray);
   insert(for_insert, dummy, {1,1});
   hpw_assert(for_insert.get(0,0) == Pal8::gray);
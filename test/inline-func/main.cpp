@@ -0,0 +1,102 @@
+#include <array>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include "util/inline-func.hpp"
+#include "util/error.hpp"
+
+using Func = Inline_func<int (int), 24>;
+
+/// функтор, который не влезет в Func
+struct Big {
+  std::array<char, 64> data {};
+  inline int operator()(int x) const { return x + data[0]; }
+};
+
+// большой функтор не должен собираться в Func, а в Inline_func побольше - должен
+static_assert( !Func::fits<Big>);
+static_assert( !std::is_constructible_v<Func, Big>);
+static_assert(std::is_constructible_v<Inline_func<int (int), 64>, Big>);
+// копировать нельзя, только перемещать
+static_assert( !std::is_copy_constructible_v<Func>);
+static_assert( !std::is_copy_assignable_v<Func>);
+static_assert(std::is_nothrow_move_constructible_v<Func>);
+static_assert(std::is_nothrow_move_assignable_v<Func>);
+
+/// считает живые копии захваченного состояния
+struct Counted {
+  inline static int alive {};
+  int val {};
+  inline explicit Counted(int v): val {v} { ++alive; }
+  inline Counted(const Counted& other): val {other.val} { ++alive; }
+  inline Counted(Counted&& other) noexcept: val {other.val} { ++alive; }
+  inline ~Counted() { --alive; }
+};
+
+void test_call() {
+  std::cout << "call test" << std::endl;
+  Func empty;
+  iferror(scast<bool>(empty), "пустой Inline_func не должен быть true");
+  Func null_func(nullptr);
+  iferror(scast<bool>(null_func), "Inline_func(nullptr) не должен быть true");
+
+  int (*fn_ptr)(int) = [](int x) { return x * 2; };
+  Func from_ptr(fn_ptr);
+  iferror( !from_ptr || from_ptr(21) != 42, "вызов через указатель на функцию");
+  int (*null_ptr)(int) {};
+  Func from_null_ptr(null_ptr);
+  iferror(scast<bool>(from_null_ptr), "нулевой указатель на функцию не должен быть true");
+
+  // захват меняется между вызовами
+  Func counter([n = 0](int x) mutable { return n += x; });
+  counter(1);
+  iferror(counter(2) != 3, "состояние функтора не сохраняется между вызовами");
+}
+
+void test_move() {
+  std::cout << "move test" << std::endl;
+  // тривиально копируемый захват
+  Func a([k = 7](int x) { return x + k; });
+  Func b(std::move(a));
+  iferror(scast<bool>(a), "после перемещения источник должен быть пустым");
+  iferror( !b || b(1) != 8, "перемещённый функтор не работает");
+  Func c;
+  c = std::move(b);
+  iferror(scast<bool>(b) || !c || c(2) != 9, "перемещающее присваивание");
+  c = std::move(c);
+  iferror( !c || c(3) != 10, "присваивание самому себе");
+
+  // нетривиальный захват
+  auto ptr = std::make_unique<int>(5);
+  Func d([p = std::move(ptr)](int x) { return x + *p; });
+  Func e(std::move(d));
+  iferror(scast<bool>(d) || e(1) != 6, "перемещение нетривиального функтора");
+}
+
+void test_destruction() {
+  std::cout << "destruction test" << std::endl;
+  Counted::alive = 0;
+  {
+    Func a([c = Counted(3)](int x) { return x + c.val; });
+    iferror(Counted::alive != 1, "захват должен жить ровно в одном экземпляре");
+    Func b(std::move(a));
+    iferror(Counted::alive != 1, "перемещение не должно оставлять копий захвата");
+    iferror(b(1) != 4, "вызов после перемещения");
+    Func c([c = Counted(4)](int x) { return x + c.val; });
+    iferror(Counted::alive != 2, "второй захват");
+    // старый захват c удаляется при присваивании
+    c = std::move(b);
+    iferror(Counted::alive != 1, "присваивание не удалило старый захват");
+    c = nullptr;
+    iferror(Counted::alive != 0 || c, "присваивание nullptr не удалило захват");
+    Func d([c = Counted(5)](int x) { return x + c.val; });
+  }
+  iferror(Counted::alive != 0, "деструктор не удалил захват");
+}
+
+int main() {
+  test_call();
+  test_move();
+  test_destruction();
+  std::cout << "all tests complete" << std::endl;
+}
@@ -44,7 +44,7 @@ int main() {
     a->val_1 = 30;
     a->val_2 = 40;
 
-    std::array<Dummy*, 100> table;
+    std::array<Pool_ptr(Dummy), 100> table;
     for (uint idx = 0; nauto it: table) {
       it = pool.new_object<Dummy>();
       it->val_1 = idx++;
@@ -58,60 +58,101 @@ int main() {
     assert(a->val_1 == 30);
     assert(a->val_2 == 40);
   }
-  { // выделение шаред памяти в пустом пуле
-    Mem_pool pool(0);
-    auto o1 = pool.new_object_shared<Dummy>();
-    auto o2 = pool.new_object_shared<Dummy>();
-    auto o3 = pool.new_object_shared<Dummy>();
-    o1->val_2 = 3;
-    o2->val_2 = 2;
-    o3->val_2 = 1;
-    assert(o1);
-    assert(o2);
-    assert(o3);
-    assert(o1->val_2);
-    assert(o2->val_2);
-    assert(o3->val_2);
+  { // присваивание Pool_ptr из new_object
+    Mem_pool pool;
+    Pool_ptr(Dummy) x;
+    assert( !x);
+    x = pool.new_object<Dummy>();
+    assert(x);
+    x->val_0 = 10;
+    Pool_ptr(Dummy) y;
+    y = x;
+    assert(y.get() == x.get());
+    assert(y->val_0 == 10);
+    Pool_ptr(Dummy) z;
+    z = std::move(y);
+    assert( !y);
+    assert(z.get() == x.get());
   }
-  { // переполнение пула c шаред объектами
-    Mem_pool pool(sizeof(Dummy) * 2);
-
-    auto a = pool.new_object_shared<Dummy>();
-    a->val_0 = 20;
-    a->val_1 = 30;
-    a->val_2 = 40;
+  { // преобразование Pool_ptr<Derived> в Pool_ptr<Base>
+    struct Base {
+      int base_val {1};
+      virtual ~Base() = default;
+      virtual int get() const { return base_val; }
+    };
+    struct Derived: Base {
+      int derived_val {2};
+      int get() const override { return derived_val; }
+    };
 
-    std::array<Shared<Dummy>, 100> table;
-    for (uint idx = 0; nauto it: table) {
-      it = pool.new_object_shared<Dummy>();
-      it->val_1 = idx++;
-    }
-    for (uint idx = 0; cnauto it: table) {
-      assert(it->val_1 == idx);
-      ++idx;
-    }
-
-    assert(a->val_0 == 20);
-    assert(a->val_1 == 30);
-    assert(a->val_2 == 40);
+    Mem_pool pool;
+    auto derived = pool.new_object<Derived>();
+    Pool_ptr(Base) base = derived;
+    assert(base.get() == derived.get());
+    assert(base->get() == 2);
+    Pool_ptr(Base) base_2;
+    base_2 = derived;
+    assert(base_2->get() == 2);
+    Pool_ptr(Base) base_3 = std::move(derived);
+    assert( !derived);
+    assert(base_3->get() == 2);
+    base_2 = pool.new_object<Derived>();
+    assert(base_2.get() != base_3.get());
   }
-  { // ресет шаред памяти
+
+  { // удалённые объекты отдают ячейку новым
     Mem_pool pool;
-    auto x = pool.new_object_shared<Dummy>();
-    x->val_0 = 10;
-    x->val_1 = 20;
-    x->val_2 = 30;
-    pool.release();
-    assert( !x);
+    auto a = pool.new_object<Dummy>();
+    auto b = pool.new_object<Dummy>();
+    auto a_addr = a.get();
+    pool.delete_object(a);
+    assert( !a);
+    auto c = pool.new_object<Dummy>();
+    assert(c.get() == a_addr);
+    assert(b.get() != c.get());
+    assert(pool.allocated() == sizeof(Dummy) * 2);
+  }
+  { // удаление производного объекта через Pool_ptr на вторую базу
+    static int destroyed = 0;
+    struct Base_a {
+      int a_val {1};
+      virtual ~Base_a() = default;
+    };
+    struct Base_b {
+      int b_val {2};
+      virtual ~Base_b() = default;
+    };
+    struct Derived: Base_a, Base_b {
+      char data [100] {};
+      ~Derived() { ++destroyed; }
+    };
 
-    x = pool.new_object_shared<Dummy>();
-    assert(x);
-    x->val_0 = 10;
-    x->val_1 = 20;
-    x->val_2 = 30;
-    assert(x->val_0 == 10);
-    assert(x->val_1 == 20);
-    assert(x->val_2 == 30);
+    Mem_pool pool;
+    auto derived = pool.new_object<Derived>();
+    auto derived_addr = derived.get();
+    Pool_ptr(Base_b) base = derived;
+    assert(cptr2ptr<CP<void>>(base.get()) != cptr2ptr<CP<void>>(derived_addr));
+    assert(pool.allocated() == sizeof(Derived));
+    pool.delete_object(base);
+    assert( !base);
+    assert(destroyed == 1);
+    assert(pool.allocated() == 0);
+    // ячейка освободилась целиком и отдаётся такому же объекту
+    auto again = pool.new_object<Derived>();
+    assert(again.get() == derived_addr);
+  }
+  { // release не отдаёт память и не даёт ей расти
+    Mem_pool pool(sizeof(Dummy) * 4);
+    cfor (_, 100)
+      pool.new_object<Dummy>();
+    cauto reserved = pool.reserved();
+    cfor (_, 10) {
+      pool.release();
+      assert(pool.allocated() == 0);
+      cfor (_, 100)
+        pool.new_object<Dummy>();
+      assert(pool.reserved() == reserved);
+    }
   }
 
   hpw_log("mem pool tests end\n");
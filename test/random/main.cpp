@@ -1,6 +1,7 @@
 #include <omp.h>
 #include <functional>
 #include <array>
+#include <vector>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
@@ -194,10 +195,67 @@ void test_4() {
 
 } // test 3
 
+/// значения из потока по номеру, как у объекта с этим uid
+std::vector<uint32_t> gen_stream_values(uint64_t stream_id, uint count) {
+  auto stream = make_rnd_stream(stream_id);
+  std::vector<uint32_t> ret(count);
+  for (nauto val: ret)
+    val = stream.rndu();
+  return ret;
+}
+
+/// Rnd_stream: воспроизводимость, независимость потоков, сохранение состояния
+void test_5() {
+  std::cout << "\nRnd_stream test" << std::endl;
+  constexpr uint streams {1'000};
+  constexpr uint count {64};
+  set_rnd_seed(1703101347u);
+
+  // параллельно каждый поток берёт значения из своего Rnd_stream
+  std::vector<std::vector<uint32_t>> parallel(streams);
+  #pragma omp parallel for schedule(dynamic)
+  cfor (i, streams)
+    parallel[i] = gen_stream_values(i, count);
+
+  // то же самое в одном потоке, вперемешку со стабильным рандомом
+  set_rnd_seed(1703101347u);
+  cfor (i, streams) {
+    do_not_optimize(rnd());
+    iferror(gen_stream_values(i, count) != parallel[i], "Rnd_stream parallel test failed");
+  }
+
+  // другой сид или номер - другие значения
+  iferror(parallel[0] == parallel[1], "Rnd_stream streams are equal");
+  set_rnd_seed(17'245'124u);
+  iferror(gen_stream_values(0, count) == parallel[0], "Rnd_stream ignores seed");
+
+  // сохранение и восстановление состояния
+  Rnd_stream stream(1703101347u, 7);
+  cfor (_, 10)
+    do_not_optimize(stream.next());
+  cauto saved = stream.get_state();
+  cauto a = stream.rndr();
+  cauto b = stream.rnd(-100, 100);
+  Rnd_stream restored;
+  restored.set_state(saved);
+  iferror(restored.rndr() != a || restored.rnd(-100, 100) != b, "Rnd_stream state restore failed");
+  iferror(restored != stream, "Rnd_stream restored != stream");
+
+  // split детерминирован и не совпадает с исходным потоком
+  Rnd_stream c(1703101347u, 7);
+  Rnd_stream d(1703101347u, 7);
+  auto c_child = c.split();
+  auto d_child = d.split();
+  iferror(c_child != d_child, "Rnd_stream split is not stable");
+  iferror(c_child == c, "Rnd_stream split == parent");
+  std::cout << "Rnd_stream test complete" << std::endl;
+} // test_5
+
 int main() {
   test_1();
   test_2();
   test_3();
   test_4();
+  test_5();
   std::cout << "\nall tests complete" << std::endl;
 } // main
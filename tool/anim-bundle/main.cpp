@@ -0,0 +1,30 @@
+#include <iostream>
+#include "util/str.hpp"
+#include "util/macro.hpp"
+#include "util/error.hpp"
+#include "util/file/file.hpp"
+#include "util/file/yaml.hpp"
+#include "graphic/animation/anim-bundle.hpp"
+
+/** собирает config/animation.yml в бинарный пакет config/animation.bin.
+Пакет кладётся в data.zip рядом с yml: игра грузит его, если он собран
+из того же animation.yml, иначе читает yml как раньше
+* @param argv[1] путь до animation.yml
+* @param argv[2] куда сохранить пакет */
+int main(int argc, char *argv[]) {
+  const Str src_name = argc > 1 ? argv[1] : "config/animation.yml";
+  const Str dst_name = argc > 2 ? argv[2] : "config/animation.bin";
+
+  try {
+    cauto src_mem = mem_from_file(src_name);
+    const Yaml src_yml(src_name);
+    cauto bundle = anim_bundle::compile(src_yml, anim_bundle::source_hash(src_mem));
+    mem_to_file(anim_bundle::save(bundle), dst_name);
+    std::cout << "complete \"" << dst_name << "\": " << bundle.anims.size()
+      << " anims, " << bundle.frames.size() << " frames, "
+      << bundle.polys.size() << " polygons" << std::endl;
+  } catch (CN<hpw::Error> err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+}